@@ -0,0 +1,18 @@
+#pragma once
+
+#include <chrono>
+
+// Wall clock seconds spent in f.
+template <typename F>
+double measureSeconds(F &&f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nanoseconds per operation.
+inline double nsPerOp(double seconds, size_t ops)
+{
+    return seconds * 1e9 / static_cast<double>(ops);
+}
@@ -0,0 +1,72 @@
+// Steps a BoardBatch of radius 10 boards with random actions and reports board-steps per
+// second, for stepping alone, with a colour observation every step and with one-hot
+// float observation planes every step.
+//
+// Usage: board_batch [boards] [steps], defaults to 4096 and 2000.
+
+#include "bench.hpp"
+#include "board_batch.hpp"
+#include "observation.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <print>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    size_t boards = argc > 1 ? std::stoul(argv[1]) : 4096;
+    size_t steps = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    BoardBatch batch(HexagonLayout(10), boards);
+    batch.randomize(1);
+
+    // Actions are drawn up front so the timing covers the batch alone.
+    Xoshiro256 rng(2);
+    std::vector<std::uint32_t> actions(boards * steps);
+    for (std::uint32_t &action : actions)
+    {
+        action = static_cast<std::uint32_t>(rng() % batch.getActionCount());
+    }
+    std::vector<float> rewards(boards);
+    std::vector<PaletteIndex> observation(boards * batch.getCellCount());
+    const ObservationEncoder encoder(HexagonLayout(10));
+    std::vector<float> planes(boards * encoder.getObservationSize());
+
+    double rewardSum = 0.0;
+    double stepSeconds = measureSeconds([&]
+                                        {
+        for (size_t step = 0; step < steps; step++)
+        {
+            batch.step(std::span(actions).subspan(step * boards, boards), rewards);
+            rewardSum += rewards[0];
+        } });
+
+    double observeSeconds = measureSeconds([&]
+                                           {
+        for (size_t step = 0; step < steps; step++)
+        {
+            batch.step(std::span(actions).subspan(step * boards, boards), rewards);
+            batch.observe(observation);
+        } });
+
+    // Far more bytes per step, so fewer steps.
+    const size_t planeSteps = std::max<size_t>(steps / 20, 1);
+    double planeSeconds = measureSeconds([&]
+                                         {
+        for (size_t step = 0; step < planeSteps; step++)
+        {
+            batch.step(std::span(actions).subspan(step * boards, boards), rewards);
+            encoder.encode(batch, std::span(planes));
+        } });
+
+    const double boardSteps = static_cast<double>(boards * steps);
+    std::println("{} boards x {} steps ({} cells, {} actions, reward sum {})", boards, steps, batch.getCellCount(),
+                 batch.getActionCount(), rewardSum);
+    std::println("  step             {:>7.2f} M board-steps/s", boardSteps / stepSeconds / 1e6);
+    std::println("  step + observe   {:>7.2f} M board-steps/s", boardSteps / observeSeconds / 1e6);
+    std::println("  step + planes    {:>7.2f} M board-steps/s  ({}x{}x{} floats per board)",
+                 static_cast<double>(boards * planeSteps) / planeSeconds / 1e6,
+                 ObservationEncoder::PLANE_COUNT, encoder.getHeight(), encoder.getWidth());
+    return 0;
+}
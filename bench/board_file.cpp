@@ -0,0 +1,56 @@
+// Saves generated boards as board files, then times opening them, which only maps the
+// file, against generating the board again, a first full scan of the mapped colours and
+// a copy into a playable HexMap.
+//
+// Usage: board_file [directory], defaults to the system's temporary directory.
+
+#include "bench.hpp"
+#include "board_file.hpp"
+#include "generate.hpp"
+#include <filesystem>
+#include <print>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    const std::filesystem::path directory = argc > 1 ? std::filesystem::path(argv[1])
+                                                     : std::filesystem::temp_directory_path();
+
+    for (int radius : {100, 1000, 2000})
+    {
+        const std::uint64_t seed = 1;
+        HexMap generated{HexagonLayout(1)};
+        double generateSeconds = measureSeconds([&]
+                                                { generated = generateHexMap(radius, seed); });
+
+        const std::filesystem::path path = directory / ("heximeter_bench_" + std::to_string(radius) + ".hexb");
+        double saveSeconds = measureSeconds([&]
+                                            { saveBoard(path, generated, seed); });
+
+        MappedBoard board(path);
+        double openSeconds = measureSeconds([&]
+                                            { board = MappedBoard(path); });
+
+        size_t sum = 0;
+        double scanSeconds = measureSeconds([&]
+                                            { board.getColors().forEach([&](size_t, PaletteIndex color)
+                                                                        { sum += color; }); });
+        size_t denseSum = 0;
+        for (PaletteIndex color : generated.getColors())
+        {
+            denseSum += color;
+        }
+
+        HexMap loaded{HexagonLayout(1)};
+        double copySeconds = measureSeconds([&]
+                                            { loaded = board.toHexMap(); });
+
+        std::println("radius {:>4}: {:>8} cells, {:>7} KiB file  generate {:>8.2f} ms  save {:>7.2f} ms  open {:>7.3f} ms  first scan {:>5.2f} ns/cell{}  toHexMap {:>8.2f} ms{}",
+                     radius, generated.size(), std::filesystem::file_size(path) / 1024, generateSeconds * 1e3,
+                     saveSeconds * 1e3, openSeconds * 1e3, nsPerOp(scanSeconds, board.size()),
+                     sum == denseSum ? "" : " (sums differ)", copySeconds * 1e3,
+                     loaded.getHash() == generated.getHash() ? "" : " (hashes differ)");
+        std::filesystem::remove(path);
+    }
+    return 0;
+}
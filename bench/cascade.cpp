@@ -0,0 +1,124 @@
+// Settles generated boards, then plays random rotations and cascades after each one, and
+// reports the time per wave and per changed cell along with how long the cascades ran.
+// Gravity alone runs up to MAX_CASCADE_WAVES waves and is counted by how often it settles
+// the board. With CascadeEnd::RecolourInPlace, the runs that still have clusters after
+// FALLING_WAVES waves end with an in-place wave; a check replays every such run with
+// gravity alone on a copy of the board and fails the bench unless that wave fired exactly
+// when gravity left clusters, and the board always ended stable.
+//
+// Usage: cascade [rotations], defaults to 1000 at radius 10 and a tenth of that at
+// radius 100. Gravity alone nearly always runs to the wave limit, so it plays a tenth of
+// those again.
+
+#include "bench.hpp"
+#include "cascade.hpp"
+#include "generate.hpp"
+#include "match.hpp"
+#include "rotation.hpp"
+#include <algorithm>
+#include <print>
+#include <random>
+#include <string>
+
+const size_t FALLING_WAVES{4};
+
+namespace
+{
+    struct RunTotals
+    {
+        size_t waves = 0;
+        size_t changes = 0;
+        size_t longest = 0;
+        size_t stable = 0;
+        size_t recoloured = 0;
+    };
+
+    RunTotals playRotations(HexMap &hexMap, Cascade &cascade, const TriangleTable &triangles, size_t rotations,
+                            Xoshiro256 &rng, std::mt19937_64 &picks, size_t maxWaves, CascadeEnd end)
+    {
+        RunTotals totals;
+        for (size_t i = 0; i < rotations; i++)
+        {
+            const IndexCycle &cycle = triangles.getCycle(picks() % triangles.size());
+            hexMap.applyCycle(cycle);
+            const size_t waves = cascade.run(hexMap, cycle.cells, rng, maxWaves, end);
+            totals.waves += waves;
+            totals.longest = std::max(totals.longest, waves);
+            totals.stable += cascade.isStable();
+            totals.recoloured += cascade.wasRecoloured();
+            for (size_t wave = 0; wave < waves; wave++)
+            {
+                totals.changes += cascade.getWave(wave).cells.size();
+            }
+        }
+        return totals;
+    }
+
+    // Plays rotations with the in-place end, each also with gravity alone on a copy of the
+    // board and generator. Returns the runs that disagree or end with clusters.
+    size_t checkRecolourInPlace(HexMap &hexMap, Cascade &cascade, const TriangleTable &triangles,
+                                size_t rotations, Xoshiro256 &rng, std::mt19937_64 &picks)
+    {
+        MatchFinder finder(hexMap.getLayout());
+        size_t failures = 0;
+        for (size_t i = 0; i < rotations; i++)
+        {
+            const IndexCycle &cycle = triangles.getCycle(picks() % triangles.size());
+            hexMap.applyCycle(cycle);
+            HexMap gravityMap = hexMap;
+            Xoshiro256 gravityRng = rng;
+            cascade.run(gravityMap, cycle.cells, gravityRng, FALLING_WAVES, CascadeEnd::Stop);
+            const bool gravitySettled = cascade.isStable();
+
+            cascade.run(hexMap, cycle.cells, rng, FALLING_WAVES, CascadeEnd::RecolourInPlace);
+            failures += cascade.wasRecoloured() == gravitySettled || !cascade.isStable() ||
+                        !finder.findAll(hexMap.getPaddedColors()).empty();
+        }
+        return failures;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t rotations = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+    size_t failures = 0;
+    for (int radius : {10, 100})
+    {
+        const size_t radiusRotations = radius > 10 ? std::max<size_t>(rotations / 10, 1) : rotations;
+        const size_t gravityRotations = std::max<size_t>(radiusRotations / 10, 1);
+        HexMap hexMap = generateHexMap(radius, 1);
+        const TriangleTable triangles(hexMap.getLayout());
+        Cascade cascade(hexMap.getLayout(), HexDirection::NorthEast);
+        Xoshiro256 rng(1);
+        std::mt19937_64 picks(1);
+
+        double settleSeconds = measureSeconds([&]
+                                              { cascade.settle(hexMap, rng); });
+        const size_t settleWaves = cascade.getWaveCount();
+
+        RunTotals gravity;
+        double gravitySeconds = measureSeconds([&]
+                                               { gravity = playRotations(hexMap, cascade, triangles, gravityRotations,
+                                                                         rng, picks, MAX_CASCADE_WAVES, CascadeEnd::Stop); });
+        cascade.settle(hexMap, rng);
+        RunTotals recolour;
+        double recolourSeconds = measureSeconds([&]
+                                                { recolour = playRotations(hexMap, cascade, triangles, radiusRotations, rng,
+                                                                           picks, FALLING_WAVES, CascadeEnd::RecolourInPlace); });
+        const size_t checkFailures = checkRecolourInPlace(hexMap, cascade, triangles, radiusRotations, rng, picks);
+        failures += checkFailures;
+
+        std::println("radius {:>3}: settle {:>8.1f} us ({} waves)", radius, settleSeconds * 1e6, settleWaves);
+        std::println("  gravity alone:     {:>9.1f} ns/wave  {:>5.1f} ns/changed cell  {:>6.2f} waves/rotation, at most {:>3}, {} of {} runs settled",
+                     nsPerOp(gravitySeconds, gravity.waves), nsPerOp(gravitySeconds, gravity.changes),
+                     static_cast<double>(gravity.waves) / static_cast<double>(gravityRotations), gravity.longest,
+                     gravity.stable, gravityRotations);
+        std::println("  recolour in place: {:>9.1f} ns/wave  {:>5.1f} ns/changed cell  {:>6.2f} waves/rotation, at most {:>3}, {} of {} runs recoloured after {} waves, check {}",
+                     nsPerOp(recolourSeconds, recolour.waves), nsPerOp(recolourSeconds, recolour.changes),
+                     static_cast<double>(recolour.waves) / static_cast<double>(radiusRotations), recolour.longest,
+                     recolour.recoloured, radiusRotations, FALLING_WAVES,
+                     checkFailures == 0 ? "passed" : std::to_string(checkFailures) + " runs failed");
+    }
+    return failures == 0 ? 0 : 1;
+}
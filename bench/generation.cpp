@@ -0,0 +1,42 @@
+// Generates random hexagon boards on 1, 2, 4, ... threads and reports cells per second,
+// both for the colours alone and for a whole HexMap, and checks every thread count
+// produced the same board.
+//
+// Usage: generation [radius] [max threads], defaults to 1000 and every hardware thread.
+
+#include "bench.hpp"
+#include "generate.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <print>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    int radius = argc > 1 ? std::stoi(argv[1]) : 1000;
+    const std::uint64_t seed = 1;
+    const unsigned maxThreads = resolveThreadCount(argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 0);
+    const std::vector<PaletteIndex> reference = generateHexagonColors(radius, seed, 1);
+
+    std::println("radius {} ({} cells), up to {} threads", radius, reference.size(), maxThreads);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::vector<PaletteIndex> colors;
+        double colorSeconds = measureSeconds([&]
+                                             { colors = generateHexagonColors(radius, seed, threads); });
+
+        HexMap hexMap{HexagonLayout(0)};
+        double mapSeconds = measureSeconds([&]
+                                           { hexMap = generateHexMap(radius, seed, threads); });
+
+        bool identical = colors == reference && std::ranges::equal(hexMap.getColors(), reference);
+        std::println("{:>3} threads: colours {:>8.1f} M cells/s  HexMap {:>8.1f} M cells/s  {}",
+                     threads,
+                     static_cast<double>(reference.size()) / colorSeconds / 1e6,
+                     static_cast<double>(reference.size()) / mapSeconds / 1e6,
+                     identical ? "identical" : "MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Compares std::unordered_map<Hex, ...> with the hash HexMap used before HexKey against
+// FlatHashMap<HexKey, ...> and ChunkedHexMap for insert, lookup and full iteration.
+//
+// Usage: hex_maps [max cells], defaults to 10M.
+
+#include "bench.hpp"
+#include "chunked_hex_map.hpp"
+#include "flat_hash_map.hpp"
+#include "hex.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The golden ratio combine std::hash<Hex> used before HexKey.
+struct LegacyHexHash
+{
+    size_t operator()(const Hex &h) const
+    {
+        std::hash<int> int_hash;
+        size_t hq = int_hash(h.q);
+        size_t hr = int_hash(h.r);
+        return hq ^ (hr + 0x9e3779b9 + (hq << 6) + (hq >> 2));
+    }
+};
+
+// The first count cells of a hexagon big enough to hold them, in a fixed shuffled order.
+std::vector<Hex> makeHexes(size_t count)
+{
+    int radius = 0;
+    while (static_cast<size_t>(3 * radius * (radius + 1) + 1) < count)
+    {
+        radius++;
+    }
+
+    std::vector<Hex> hexes;
+    hexes.reserve(count);
+    for (int q = -radius; q <= radius && hexes.size() < count; q++)
+    {
+        int r1 = std::max(-radius, -q - radius);
+        int r2 = std::min(radius, -q + radius);
+        for (int r = r1; r <= r2 && hexes.size() < count; r++)
+        {
+            hexes.emplace_back(q, r, -q - r);
+        }
+    }
+
+    std::mt19937_64 rng(42);
+    std::shuffle(hexes.begin(), hexes.end(), rng);
+    return hexes;
+}
+
+struct Result
+{
+    double insert;
+    double lookup;
+    double iterate;
+    std::uint64_t checksum;
+};
+
+template <typename Map, typename ToKey>
+Result run(const std::vector<Hex> &hexes, const std::vector<Hex> &lookups, ToKey toKey)
+{
+    Result result{};
+    Map map;
+
+    result.insert = measureSeconds([&]
+                                   {
+        for (size_t i = 0; i < hexes.size(); i++)
+        {
+            map[toKey(hexes[i])] = static_cast<std::uint8_t>(i % 3);
+        } });
+
+    std::uint64_t found = 0;
+    result.lookup = measureSeconds([&]
+                                   {
+        for (const Hex &hex : lookups)
+        {
+            found += map.find(toKey(hex)) != nullptr;
+        } });
+
+    std::uint64_t sum = 0;
+    result.iterate = measureSeconds([&]
+                                    {
+        for (const auto &[key, value] : map)
+        {
+            sum += value;
+        } });
+
+    result.checksum = found * 1000003 + sum;
+    return result;
+}
+
+// unordered_map with a FlatHashMap style find that returns a pointer.
+template <typename Key, typename Value, typename Hash>
+struct UnorderedMap : std::unordered_map<Key, Value, Hash>
+{
+    const Value *find(const Key &key) const
+    {
+        auto it = std::unordered_map<Key, Value, Hash>::find(key);
+        return it == this->end() ? nullptr : &it->second;
+    }
+};
+
+Result runChunked(const std::vector<Hex> &hexes, const std::vector<Hex> &lookups, size_t &memory)
+{
+    Result result{};
+    ChunkedHexMap<std::uint8_t> map;
+
+    result.insert = measureSeconds([&]
+                                   {
+        for (size_t i = 0; i < hexes.size(); i++)
+        {
+            map.insert(hexes[i], static_cast<std::uint8_t>(i % 3));
+        } });
+
+    std::uint64_t found = 0;
+    result.lookup = measureSeconds([&]
+                                   {
+        for (const Hex &hex : lookups)
+        {
+            found += map.find(hex) != nullptr;
+        } });
+
+    std::uint64_t sum = 0;
+    result.iterate = measureSeconds([&]
+                                    { map.forEach([&sum](const Hex &, std::uint8_t value)
+                                                  { sum += value; }); });
+
+    result.checksum = found * 1000003 + sum;
+    memory = map.memoryUsage();
+    return result;
+}
+
+void report(const char *name, size_t count, const Result &result)
+{
+    std::println("{:<32} {:>9} cells  insert {:>7.1f} ns  lookup {:>7.1f} ns  iterate {:>6.2f} ns  (checksum {})",
+                 name, count,
+                 nsPerOp(result.insert, count),
+                 nsPerOp(result.lookup, count),
+                 nsPerOp(result.iterate, count),
+                 result.checksum);
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxCells = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+
+    for (size_t count : {size_t{10'000}, size_t{1'000'000}, size_t{10'000'000}})
+    {
+        if (count > maxCells)
+        {
+            break;
+        }
+        std::vector<Hex> hexes = makeHexes(count);
+        std::vector<Hex> lookups = hexes;
+        std::mt19937_64 rng(7);
+        std::shuffle(lookups.begin(), lookups.end(), rng);
+
+        report("unordered_map<Hex> legacy hash", count,
+               run<UnorderedMap<Hex, std::uint8_t, LegacyHexHash>>(hexes, lookups, [](const Hex &hex)
+                                                                  { return hex; }));
+        report("FlatHashMap<HexKey>", count,
+               run<FlatHashMap<HexKey, std::uint8_t>>(hexes, lookups, [](const Hex &hex)
+                                                      { return HexKey(hex); }));
+
+        size_t memory = 0;
+        report("ChunkedHexMap<uint8_t>", count, runChunked(hexes, lookups, memory));
+        std::println("{:<32} {:>9} cells  {} KiB", "ChunkedHexMap<uint8_t> memory", count, memory / 1024);
+    }
+    return 0;
+}
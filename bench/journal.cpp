@@ -0,0 +1,76 @@
+// Records random rotations on a generated board in a Journal, then undoes them all and
+// jumps to random points of the history, and reports the time per operation and the
+// bytes the journal takes per entry.
+//
+// Usage: journal [rotations], defaults to 1M.
+
+#include "bench.hpp"
+#include "generate.hpp"
+#include "journal.hpp"
+#include "rotation.hpp"
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    size_t rotations = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+    for (int radius : {10, 100})
+    {
+        HexMap hexMap = generateHexMap(radius, 1);
+        const TriangleTable triangles(hexMap.getLayout());
+        Journal journal(hexMap, triangles);
+        std::mt19937_64 rng(1);
+        std::vector<TriangleMove> moves(rotations);
+        for (TriangleMove &move : moves)
+        {
+            move = TriangleMove{static_cast<std::uint32_t>(rng() % triangles.size()),
+                                rng() % 2 == 0 ? Turn::Clockwise : Turn::CounterClockwise};
+        }
+        const std::uint64_t endHash = [&]
+        {
+            HexMap copy = hexMap;
+            for (const TriangleMove &move : moves)
+            {
+                copy.applyCycle(triangles.getCycle(move));
+            }
+            return copy.getHash();
+        }();
+
+        double recordSeconds = measureSeconds([&]
+                                              {
+            for (const TriangleMove &move : moves)
+            {
+                journal.rotate(hexMap, move);
+            } });
+
+        double undoSeconds = measureSeconds([&]
+                                            {
+            while (journal.undo(hexMap))
+            {
+            } });
+
+        const size_t jumps = 10'000;
+        std::vector<size_t> targets(jumps);
+        for (size_t &target : targets)
+        {
+            target = rng() % (rotations + 1);
+        }
+        double jumpSeconds = measureSeconds([&]
+                                            {
+            for (size_t target : targets)
+            {
+                journal.jumpTo(hexMap, target);
+            } });
+        journal.jumpTo(hexMap, rotations);
+
+        std::println("radius {:>3}: record {:>5.1f} ns  undo {:>5.1f} ns  jump {:>8.1f} ns  {:>5.2f} bytes/entry  ({} keyframes, end state {})",
+                     radius, nsPerOp(recordSeconds, rotations), nsPerOp(undoSeconds, rotations),
+                     nsPerOp(jumpSeconds, jumps),
+                     static_cast<double>(journal.memoryUsage()) / static_cast<double>(rotations),
+                     journal.getKeyframeCount(), hexMap.getHash() == endHash ? "matches" : "differs");
+    }
+    return 0;
+}
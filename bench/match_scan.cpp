@@ -0,0 +1,88 @@
+// Finds every cell in a straight run of three same coloured cells on a random hexagon
+// board, once with HexBitboards and once cell by cell through a hash map.
+//
+// Usage: match_scan [max radius], defaults to 1000.
+
+#include "bench.hpp"
+#include "flat_hash_map.hpp"
+#include "hex_bitboards.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    int maxRadius = argc > 1 ? std::stoi(argv[1]) : 1000;
+    const size_t paletteSize = 3;
+
+    for (int radius : {10, 100, 1000})
+    {
+        if (radius > maxRadius)
+        {
+            break;
+        }
+
+        std::mt19937_64 rng(1);
+        std::vector<Hex> hexes;
+        std::vector<PaletteIndex> colors;
+        FlatHashMap<HexKey, PaletteIndex> cells;
+        for (int r = -radius; r <= radius; r++)
+        {
+            for (int q = std::max(-radius, -r - radius); q <= std::min(radius, -r + radius); q++)
+            {
+                hexes.emplace_back(q, r, -q - r);
+                colors.push_back(static_cast<PaletteIndex>(rng() % paletteSize));
+                cells[HexKey(q, r)] = colors.back();
+            }
+        }
+        HexBitboards bitboards(radius, paletteSize, hexes, colors);
+
+        const int repeats = radius >= 1000 ? 3 : 100;
+        size_t bitboardMatches = 0;
+        Bitboard bitboardMatched(bitboards.getBitCount());
+        double bitboardSeconds = measureSeconds([&]
+                                                {
+            for (int i = 0; i < repeats; i++)
+            {
+                bitboards.runsOfThree(bitboardMatched);
+                bitboardMatches = bitboardMatched.count();
+            } });
+
+        const std::array<HexDirection, 3> axes{HexDirection::East, HexDirection::NorthEast, HexDirection::NorthWest};
+        size_t scanMatches = 0;
+        double scanSeconds = measureSeconds([&]
+                                            {
+            for (int i = 0; i < repeats; i++)
+            {
+                FlatHashMap<HexKey, bool> matched;
+                for (const Hex &hex : hexes)
+                {
+                    PaletteIndex color = *cells.find(HexKey(hex));
+                    for (HexDirection axis : axes)
+                    {
+                        Hex second = hexNeighbour(hex, axis);
+                        Hex third = hexNeighbour(second, axis);
+                        const PaletteIndex *secondColor = cells.find(HexKey(second));
+                        const PaletteIndex *thirdColor = cells.find(HexKey(third));
+                        if (secondColor && thirdColor && *secondColor == color && *thirdColor == color)
+                        {
+                            matched[HexKey(hex)] = true;
+                            matched[HexKey(second)] = true;
+                            matched[HexKey(third)] = true;
+                        }
+                    }
+                }
+                scanMatches = matched.size();
+            } });
+
+        std::println("radius {:>4} ({} words per colour): bitboards {:>10.1f} us  cell scan {:>10.1f} us  ({} / {} matched cells)",
+                     radius, bitboards.getColor(0).getWords().size(),
+                     bitboardSeconds * 1e6 / repeats, scanSeconds * 1e6 / repeats,
+                     bitboardMatches, scanMatches);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Plays random rotations on generated boards and looks for clusters of three or more same
+// coloured cells after each one: collecting them around the rotated triangle, only
+// testing for one there, and over the whole board, and reports the time per rotation of
+// each. Then does the same on a board of one colour, where every cluster is the board.
+//
+// Usage: matches [max radius], defaults to 1000.
+
+#include "bench.hpp"
+#include "generate.hpp"
+#include "match.hpp"
+#include "rotation.hpp"
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    int maxRadius = argc > 1 ? std::stoi(argv[1]) : 1000;
+
+    for (int radius : {10, 100, 1000})
+    {
+        if (radius > maxRadius)
+        {
+            break;
+        }
+
+        HexMap hexMap = generateHexMap(radius, 1);
+        const TriangleTable triangles(hexMap.getLayout());
+        MatchFinder finder(hexMap.getLayout());
+        std::mt19937_64 rng(1);
+
+        const size_t rotations = 1'000'000;
+        std::vector<size_t> picks(rotations);
+        for (size_t &pick : picks)
+        {
+            pick = rng() % triangles.size();
+        }
+
+        size_t localMatches = 0;
+        double localSeconds = measureSeconds([&]
+                                             {
+            for (size_t pick : picks)
+            {
+                const IndexCycle &cycle = triangles.getCycle(pick);
+                hexMap.applyCycle(cycle);
+                localMatches += finder.find(hexMap, cycle).size();
+            } });
+
+        size_t localHits = 0;
+        double testSeconds = measureSeconds([&]
+                                            {
+            for (size_t pick : picks)
+            {
+                const IndexCycle &cycle = triangles.getCycle(pick);
+                hexMap.applyCycle(cycle);
+                localHits += finder.hasMatch(hexMap, cycle);
+            } });
+
+        // A full scan per rotation, on far fewer rotations.
+        const size_t scans = radius >= 1000 ? 10 : radius >= 100 ? 1000 : 100'000;
+        size_t scanMatches = 0;
+        double scanSeconds = measureSeconds([&]
+                                            {
+            for (size_t i = 0; i < scans; i++)
+            {
+                hexMap.applyCycle(triangles.getCycle(picks[i]));
+                scanMatches += finder.findAll(hexMap.getPaddedColors()).size();
+            } });
+
+        // One colour everywhere: collecting walks the whole board, testing stops at three cells.
+        HexMap oneColor{HexagonLayout(radius)};
+        size_t oneColorMatches = 0;
+        double oneColorSeconds = measureSeconds([&]
+                                                {
+            for (size_t i = 0; i < scans; i++)
+            {
+                oneColorMatches += finder.find(oneColor, triangles.getCycle(picks[i])).size();
+            } });
+        size_t oneColorHits = 0;
+        double oneColorTestSeconds = measureSeconds([&]
+                                                    {
+            for (size_t pick : picks)
+            {
+                oneColorHits += finder.hasMatch(oneColor, triangles.getCycle(pick));
+            } });
+
+        std::println("radius {:>4} ({:>7} cells): around rotation {:>8.1f} ns/rotation  test only {:>6.1f} ns/rotation  full scan {:>12.1f} ns/rotation  ({} / {} matched cells, {} hits)",
+                     radius, hexMap.size(), nsPerOp(localSeconds, rotations), nsPerOp(testSeconds, rotations),
+                     nsPerOp(scanSeconds, scans), localMatches, scanMatches, localHits);
+        std::println("           one colour: around rotation {:>12.1f} ns/rotation  test only {:>6.1f} ns/rotation  ({} matched cells, {} hits)",
+                     nsPerOp(oneColorSeconds, scans), nsPerOp(oneColorTestSeconds, rotations), oneColorMatches,
+                     oneColorHits);
+    }
+    return 0;
+}
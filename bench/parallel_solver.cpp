@@ -0,0 +1,46 @@
+// Solves one scrambled radius 4 board with the ParallelSolver on 1, 2, 4, ... threads
+// and reports the speedup over one thread and the scaling efficiency (speedup divided
+// by threads).
+//
+// Usage: parallel_solver [scramble] [max threads], defaults to 12 and every hardware
+// thread.
+
+#include "generate.hpp"
+#include "parallel.hpp"
+#include "parallel_solver.hpp"
+#include <print>
+#include <random>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    int scramble = argc > 1 ? std::stoi(argv[1]) : 12;
+    const unsigned maxThreads = resolveThreadCount(argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 0);
+
+    const HexMap goal = generateHexMap(4, 1);
+    HexMap start = goal;
+    const TriangleTable triangles(start.getLayout());
+    std::mt19937_64 rng(static_cast<std::uint64_t>(scramble));
+    for (int i = 0; i < scramble; i++)
+    {
+        const TriangleMove move{static_cast<std::uint32_t>(rng() % triangles.size()),
+                                rng() % 2 ? Turn::Clockwise : Turn::CounterClockwise};
+        start.applyCycle(triangles.getCycle(move));
+    }
+
+    double serialSeconds = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ParallelSolver solver(start, threads);
+        const SolveResult result = solver.solve(goal.getColors(), scramble);
+        if (threads == 1)
+        {
+            serialSeconds = result.seconds;
+        }
+        const double speedup = serialSeconds / result.seconds;
+        std::println("{:>3} threads: {:<8} {:>2} moves  {:>12} nodes  {:>8.3f} s  {:>6.2f} M nodes/s  speedup {:>5.2f}  efficiency {:>4.0f}%",
+                     threads, result.solved ? "solved" : "UNSOLVED", result.moves.size(), result.nodes, result.seconds,
+                     result.nodesPerSecond() / 1e6, speedup, 100.0 * speedup / threads);
+    }
+    return 0;
+}
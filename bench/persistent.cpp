@@ -0,0 +1,110 @@
+// Forks generated boards, tries a few rotations on every fork and drops it, once with
+// PersistentHexMap snapshots and once copying a HexMap, then sums every colour of a board
+// through both to compare scans, and reports the pages 1000 live forks hold.
+//
+// Usage: persistent [forks], defaults to 100k.
+
+#include "bench.hpp"
+#include "generate.hpp"
+#include "persistent_hex_map.hpp"
+#include "rotation.hpp"
+#include <print>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    size_t forks = argc > 1 ? std::stoul(argv[1]) : 100'000;
+    const size_t movesPerFork = 4;
+
+    for (int radius : {10, 100, 1000})
+    {
+        const HexMap hexMap = generateHexMap(radius, 1);
+        const PersistentHexMap persistent(hexMap);
+        const TriangleTable triangles(hexMap.getLayout());
+        const size_t runs = radius >= 1000 ? forks / 1000 : radius >= 100 ? forks / 10 : forks;
+        std::mt19937_64 rng(1);
+        std::vector<size_t> picks(runs * movesPerFork);
+        for (size_t &pick : picks)
+        {
+            pick = rng() % triangles.size();
+        }
+
+        std::uint64_t persistentHashes = 0;
+        double persistentSeconds = measureSeconds([&]
+                                                  {
+            for (size_t run = 0; run < runs; run++)
+            {
+                PersistentHexMap fork = persistent.snapshot();
+                for (size_t move = 0; move < movesPerFork; move++)
+                {
+                    fork.applyCycle(triangles.getCycle(picks[run * movesPerFork + move]));
+                }
+                persistentHashes ^= fork.getHash();
+            } });
+
+        std::uint64_t copyHashes = 0;
+        double copySeconds = measureSeconds([&]
+                                            {
+            for (size_t run = 0; run < runs; run++)
+            {
+                HexMap fork = hexMap;
+                for (size_t move = 0; move < movesPerFork; move++)
+                {
+                    fork.applyCycle(triangles.getCycle(picks[run * movesPerFork + move]));
+                }
+                copyHashes ^= fork.getHash();
+            } });
+
+        const size_t scans = radius >= 1000 ? 10 : 1000;
+        size_t persistentSum = 0;
+        double persistentScanSeconds = measureSeconds([&]
+                                                      {
+            for (size_t scan = 0; scan < scans; scan++)
+            {
+                persistent.forEachPage([&](size_t, std::span<const PaletteIndex> colors)
+                                       {
+                    for (PaletteIndex color : colors)
+                    {
+                        persistentSum += color;
+                    } });
+            } });
+        size_t denseSum = 0;
+        double denseScanSeconds = measureSeconds([&]
+                                                 {
+            for (size_t scan = 0; scan < scans; scan++)
+            {
+                for (PaletteIndex color : hexMap.getColors())
+                {
+                    denseSum += color;
+                }
+            } });
+
+        // Live forks one rotation apart from each other, as a search frontier holds them.
+        std::vector<PersistentHexMap> live{persistent};
+        for (size_t i = 1; i < 1000; i++)
+        {
+            live.push_back(live[rng() % live.size()].snapshot());
+            live.back().applyCycle(triangles.getCycle(rng() % triangles.size()));
+        }
+        std::unordered_set<const PaletteIndex *> pages;
+        for (const PersistentHexMap &fork : live)
+        {
+            for (size_t page = 0; page < fork.getPageCount(); page++)
+            {
+                pages.insert(fork.getPage(page).data());
+            }
+        }
+
+        std::println("radius {:>4}: fork+{} moves {:>9.1f} ns vs copy {:>10.1f} ns{}  scan {:>6.2f} vs {:>6.2f} ns/cell{}  1000 forks hold {:>6} KiB of pages vs {:>7} KiB of dense colours",
+                     radius, movesPerFork, nsPerOp(persistentSeconds, runs), nsPerOp(copySeconds, runs),
+                     persistentHashes == copyHashes ? "" : " (hashes differ)",
+                     nsPerOp(persistentScanSeconds, scans * hexMap.size()), nsPerOp(denseScanSeconds, scans * hexMap.size()),
+                     persistentSum == denseSum ? "" : " (sums differ)",
+                     pages.size() * PersistentHexMap::PAGE_CELLS / 1024,
+                     live.size() * hexMap.size() / 1024);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Plays random rotations on generated boards without a window and reports rotations per
+// second, once started and stepped to completion in a single update as the game does,
+// and once applied directly as precomputed index cycles as a solver does.
+//
+// Usage: rotations [rotations], defaults to 10M.
+
+#include "bench.hpp"
+#include "generate.hpp"
+#include "hex_map.hpp"
+#include "rotation.hpp"
+#include <array>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename Layout>
+void run(const char *name, BasicHexMap<Layout> hexMap, size_t rotations)
+{
+    const TriangleTable triangles(hexMap.getLayout());
+    std::mt19937_64 rng(1);
+    std::vector<size_t> picks(rotations);
+    for (size_t &pick : picks)
+    {
+        pick = rng() % triangles.size();
+    }
+
+    double animatedSeconds = measureSeconds([&]
+                                            {
+        for (size_t pick : picks)
+        {
+            hexMap.startRotation(triangles.getHexes(pick));
+            hexMap.stepRotation(1.0f);
+        } });
+
+    const auto cycles = triangles.getCycles();
+    double cycleSeconds = measureSeconds([&]
+                                         {
+        for (size_t pick : picks)
+        {
+            hexMap.applyCycle(cycles[pick]);
+        } });
+
+    std::println("{:<14} {:>8} cells: animated {:>6.1f} ns/rotation  cycles {:>6.2f} ns/rotation ({:>7.1f} M/s)",
+                 name, hexMap.size(), nsPerOp(animatedSeconds, rotations), nsPerOp(cycleSeconds, rotations),
+                 static_cast<double>(rotations) / cycleSeconds / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    size_t rotations = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+
+    run("HexMap", generateHexMap(10, 1), rotations);
+    run("HexMapFixed", generateHexMapFixed<10>(1), rotations);
+    run("HexMap", generateHexMap(100, 1), rotations);
+    return 0;
+}
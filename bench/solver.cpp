@@ -0,0 +1,40 @@
+// Scrambles random radius 3 and 4 boards with a number of random moves and solves them
+// back with the IDA* Solver, reporting the solution length, nodes per second and memory.
+//
+// Usage: solver [max scramble], defaults to 8.
+
+#include "generate.hpp"
+#include "solver.hpp"
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    int maxScramble = argc > 1 ? std::stoi(argv[1]) : 8;
+
+    for (int radius : {3, 4})
+    {
+        for (int scramble = 2; scramble <= maxScramble; scramble += 2)
+        {
+            const HexMap goal = generateHexMap(radius, static_cast<std::uint64_t>(scramble));
+            HexMap start = goal;
+            const TriangleTable triangles(start.getLayout());
+            std::mt19937_64 rng(static_cast<std::uint64_t>(radius * 100 + scramble));
+            for (int i = 0; i < scramble; i++)
+            {
+                const TriangleMove move{static_cast<std::uint32_t>(rng() % triangles.size()),
+                                        rng() % 2 ? Turn::Clockwise : Turn::CounterClockwise};
+                start.applyCycle(triangles.getCycle(move));
+            }
+
+            Solver solver(start);
+            const SolveResult result = solver.solve(goal.getColors(), scramble);
+            std::println("radius {} scramble {:>2}: {:<8} {:>2} moves  {:>12} nodes  {:>8.3f} s  {:>6.2f} M nodes/s  {:>5.1f} MB",
+                         radius, scramble, result.solved ? "solved" : "UNSOLVED", result.moves.size(), result.nodes,
+                         result.seconds, result.nodesPerSecond() / 1e6, static_cast<double>(result.memoryUsage) / 1e6);
+        }
+    }
+    return 0;
+}
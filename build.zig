@@ -17,6 +17,10 @@ pub fn build(b: *std.Build) void {
     // set a preferred release mode, allowing the user to decide how to optimize.
     const optimize = b.standardOptimizeOption(.{});
 
+    // The game logic builds as its own library without raylib, so it also runs headless.
+    const core = addCore(b, target, optimize);
+    targets.append(core) catch @panic("OOM");
+
     const exe = b.addExecutable(.{
         .name = "heximeter",
         .target = target,
@@ -25,9 +29,10 @@ pub fn build(b: *std.Build) void {
     // keep track of it, so later we can pass it to compile_commands
     targets.append(exe) catch @panic("OOM");
 
-    exe.addCSourceFiles(.{ .files = &src, .flags = &.{ "-std=c++23", "-Wall", "-Wextra", "-Wpedantic", "-Wshadow", "-Wconversion", "-Wsign-conversion", "-Wformat=2", "-gen-cdb-fragment-path", "cdb" } });
+    exe.addCSourceFiles(.{ .files = &src, .flags = &cpp_flags });
     exe.linkLibCpp();
     exe.linkLibC();
+    exe.linkLibrary(core);
 
     const raylib_optimize = b.option(
         std.builtin.OptimizeMode,
@@ -76,6 +81,32 @@ pub fn build(b: *std.Build) void {
     const run_step = b.step("run", "Run the app");
     run_step.dependOn(&run_cmd.step);
 
+    // Benchmarks always build optimized, numbers from a debug build mean nothing.
+    // `zig build bench` builds and runs all of them.
+    // They only link the core, no window is ever opened.
+    const bench_step = b.step("bench", "Build and run the benchmarks");
+    const bench_core = addCore(b, target, .ReleaseFast);
+    for (benches) |bench_src| {
+        const bench = b.addExecutable(.{
+            .name = std.fs.path.stem(bench_src),
+            .target = target,
+            .optimize = .ReleaseFast,
+        });
+        targets.append(bench) catch @panic("OOM");
+
+        bench.addCSourceFiles(.{ .files = &.{bench_src}, .flags = &cpp_flags });
+        bench.addIncludePath(b.path("src"));
+        bench.linkLibCpp();
+        bench.linkLibC();
+        bench.linkLibrary(bench_core);
+
+        const run_bench = b.addRunArtifact(bench);
+        if (b.args) |args| {
+            run_bench.addArgs(args);
+        }
+        bench_step.dependOn(&run_bench.step);
+    }
+
     const exe_unit_tests = b.addTest(.{
         .root_source_file = b.path("zigsrc/main.zig"),
         .target = target,
@@ -91,6 +122,49 @@ pub fn build(b: *std.Build) void {
     test_step.dependOn(&run_exe_unit_tests.step);
 }
 
+// The game logic without raylib, so it builds and runs headless.
+fn addCore(b: *std.Build, target: std.Build.ResolvedTarget, optimize: std.builtin.OptimizeMode) *std.Build.Step.Compile {
+    const core = b.addStaticLibrary(.{
+        .name = "heximeter-core",
+        .target = target,
+        .optimize = optimize,
+    });
+    core.addCSourceFiles(.{ .files = &core_src, .flags = &cpp_flags });
+    core.linkLibCpp();
+    core.linkLibC();
+    return core;
+}
+
+// The raylib front end: input, drawing and the game loop.
 const src = [_][]const u8{
     "src/main.cpp",
 };
+
+const core_src = [_][]const u8{
+    "src/hex_map.cpp",
+    "src/generate.cpp",
+    "src/solver.cpp",
+    "src/parallel_solver.cpp",
+    "src/board_batch.cpp",
+    "src/match.cpp",
+    "src/cascade.cpp",
+    "src/journal.cpp",
+    "src/board_file.cpp",
+};
+
+const benches = [_][]const u8{
+    "bench/hex_maps.cpp",
+    "bench/match_scan.cpp",
+    "bench/rotations.cpp",
+    "bench/generation.cpp",
+    "bench/solver.cpp",
+    "bench/parallel_solver.cpp",
+    "bench/board_batch.cpp",
+    "bench/matches.cpp",
+    "bench/cascade.cpp",
+    "bench/journal.cpp",
+    "bench/persistent.cpp",
+    "bench/board_file.cpp",
+};
+
+const cpp_flags = [_][]const u8{ "-std=c++23", "-Wall", "-Wextra", "-Wpedantic", "-Wshadow", "-Wconversion", "-Wsign-conversion", "-Wformat=2", "-gen-cdb-fragment-path", "cdb" };
@@ -0,0 +1,206 @@
+#include "board_batch.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+static_assert(std::endian::native == std::endian::little,
+              "transposeBytes() takes byte j of a row word to be column j, as memcpy() loads it on little endian");
+
+// Transposes an 8x8 byte matrix held one row per word, by swapping ever smaller blocks.
+void transposeBytes(std::array<std::uint64_t, 8> &rows)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        const std::uint64_t t = ((rows[i] >> 32) ^ rows[i + 4]) & 0x00000000FFFFFFFF;
+        rows[i] ^= t << 32;
+        rows[i + 4] ^= t;
+    }
+    for (size_t i : std::array<size_t, 4>{0, 1, 4, 5})
+    {
+        const std::uint64_t t = ((rows[i] >> 16) ^ rows[i + 2]) & 0x0000FFFF0000FFFF;
+        rows[i] ^= t << 16;
+        rows[i + 2] ^= t;
+    }
+    for (size_t i : std::array<size_t, 4>{0, 2, 4, 6})
+    {
+        const std::uint64_t t = ((rows[i] >> 8) ^ rows[i + 1]) & 0x00FF00FF00FF00FF;
+        rows[i] ^= t << 8;
+        rows[i + 1] ^= t;
+    }
+}
+} // namespace
+
+void BoardBatch::randomize(std::uint64_t seed)
+{
+    Xoshiro256 rng(seed);
+    fillPaletteIndices(rng, std::span(colors).first(cellCount * boardCount), PALETTE_SIZE);
+}
+
+void BoardBatch::setBoard(size_t board, std::span<const PaletteIndex> boardColors)
+{
+    if (boardColors.size() != cellCount)
+    {
+        throw std::invalid_argument("BoardBatch: one colour per cell expected");
+    }
+    for (size_t cell = 0; cell < cellCount; cell++)
+    {
+        colors[cell * boardCount + board] = boardColors[cell];
+    }
+}
+
+void BoardBatch::getBoard(size_t board, std::span<PaletteIndex> out) const
+{
+    for (size_t cell = 0; cell < cellCount; cell++)
+    {
+        out[cell] = colors[cell * boardCount + board];
+    }
+}
+
+void BoardBatch::buildRows(const NeighbourTable &neighbours)
+{
+    if (colors.size() > UINT32_MAX)
+    {
+        throw std::length_error("BoardBatch: too many cells for 32-bit row offsets");
+    }
+    const auto row = [this](size_t cell)
+    { return static_cast<std::uint32_t>(cell * boardCount); };
+
+    for (std::uint32_t action = 0; action < getActionCount(); action++)
+    {
+        const IndexCycle cycle = triangles.getCycle(actionMove(action));
+        actionRows.push_back({row(cycle.cells[0]), row(cycle.cells[1]), row(cycle.cells[2])});
+    }
+
+    // East, NorthEast and NorthWest cover the three axes, each paired with its opposite.
+    const std::array<size_t, 3> axes{0, 5, 4};
+    for (size_t triangle = 0; triangle < triangles.size(); triangle++)
+    {
+        RewardStencil &stencil = stencilRows.emplace_back();
+        const IndexCycle &cycle = triangles.getCycle(triangle);
+        for (size_t i = 0; i < cycle.cells.size(); i++)
+        {
+            for (size_t axis = 0; axis < axes.size(); axis++)
+            {
+                const size_t forward = axes[axis];
+                const size_t backward = (forward + 3) % 6;
+                const size_t forward1 = neighbours.neighbour(cycle.cells[i], static_cast<HexDirection>(forward));
+                const size_t backward1 = neighbours.neighbour(cycle.cells[i], static_cast<HexDirection>(backward));
+                stencil[i][axis] = {row(forward1), row(neighbours.neighbour(forward1, static_cast<HexDirection>(forward))),
+                                    row(backward1), row(neighbours.neighbour(backward1, static_cast<HexDirection>(backward)))};
+            }
+        }
+    }
+}
+
+void BoardBatch::applyActions(std::span<const std::uint32_t> actions)
+{
+    PaletteIndex *block = colors.data();
+    for (size_t board = 0; board < boardCount; board++)
+    {
+        const std::array<std::uint32_t, 3> &rows = actionRows[actions[board]];
+        PaletteIndex *cell0 = block + rows[0] + board;
+        PaletteIndex *cell1 = block + rows[1] + board;
+        PaletteIndex *cell2 = block + rows[2] + board;
+        const PaletteIndex first = *cell0;
+        *cell0 = *cell1;
+        *cell1 = *cell2;
+        *cell2 = first;
+    }
+}
+
+std::uint32_t BoardBatch::matchedCells(std::uint32_t action, size_t board) const
+{
+    // Clockwise and counter-clockwise turns of a triangle touch the same cells, and the
+    // stencil lists them in the triangle's own order.
+    const RewardStencil &stencil = stencilRows[action / 2];
+    const std::array<std::uint32_t, 3> &cycleRows = actionRows[action & ~std::uint32_t{1}];
+    const PaletteIndex *block = colors.data() + board;
+    std::uint32_t matched = 0;
+    for (size_t i = 0; i < stencil.size(); i++)
+    {
+        const PaletteIndex color = block[cycleRows[i]];
+        bool inRun = false;
+        for (const std::array<std::uint32_t, 4> &line : stencil[i])
+        {
+            const bool f1 = block[line[0]] == color;
+            const bool f2 = block[line[1]] == color;
+            const bool b1 = block[line[2]] == color;
+            const bool b2 = block[line[3]] == color;
+            inRun |= (f1 & (f2 | b1)) | (b1 & b2);
+        }
+        matched += inRun;
+    }
+    return matched;
+}
+
+void BoardBatch::computeRewards(std::span<const std::uint32_t> actions, std::span<float> rewards) const
+{
+    for (size_t board = 0; board < boardCount; board++)
+    {
+        rewards[board] = static_cast<float>(matchedCells(actions[board], board));
+    }
+}
+
+void BoardBatch::step(std::span<const std::uint32_t> actions, std::span<float> rewards)
+{
+    // One pass, so the reward reads cells the rotation just brought into cache.
+    PaletteIndex *block = colors.data();
+    for (size_t board = 0; board < boardCount; board++)
+    {
+        const std::uint32_t action = actions[board];
+        const std::array<std::uint32_t, 3> &rows = actionRows[action];
+        PaletteIndex *cell0 = block + rows[0] + board;
+        PaletteIndex *cell1 = block + rows[1] + board;
+        PaletteIndex *cell2 = block + rows[2] + board;
+        const PaletteIndex first = *cell0;
+        *cell0 = *cell1;
+        *cell1 = *cell2;
+        *cell2 = first;
+        rewards[board] = static_cast<float>(matchedCells(action, board));
+    }
+}
+
+void BoardBatch::observe(std::span<PaletteIndex> out) const
+{
+    observe(0, boardCount, out);
+}
+
+void BoardBatch::observe(size_t firstBoard, size_t count, std::span<PaletteIndex> out) const
+{
+    // Eight cells of eight boards at a time: eight 64-bit loads, a transpose in
+    // registers and eight 64-bit stores, instead of 64 byte sized scatters.
+    const size_t fullCells = cellCount - cellCount % 8;
+    const size_t fullBoards = count - count % 8;
+    for (size_t tileBoard = 0; tileBoard < fullBoards; tileBoard += 8)
+    {
+        for (size_t firstCell = 0; firstCell < fullCells; firstCell += 8)
+        {
+            std::array<std::uint64_t, 8> rows;
+            for (size_t i = 0; i < rows.size(); i++)
+            {
+                std::memcpy(&rows[i], colors.data() + (firstCell + i) * boardCount + firstBoard + tileBoard,
+                            sizeof(rows[i]));
+            }
+            transposeBytes(rows);
+            for (size_t i = 0; i < rows.size(); i++)
+            {
+                std::memcpy(out.data() + (tileBoard + i) * cellCount + firstCell, &rows[i], sizeof(rows[i]));
+            }
+        }
+    }
+
+    // The boards and cells left over.
+    for (size_t board = 0; board < count; board++)
+    {
+        const size_t firstCell = board < fullBoards ? fullCells : 0;
+        for (size_t cell = firstCell; cell < cellCount; cell++)
+        {
+            out[board * cellCount + cell] = colors[cell * boardCount + firstBoard + board];
+        }
+    }
+}
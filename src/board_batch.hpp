@@ -0,0 +1,89 @@
+#pragma once
+
+#include "hex_map.hpp"
+#include "palette.hpp"
+#include "rotation.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * N boards of one shape stepped in lockstep, for training bots on many games at once.
+ * Colours are stored cell major: the same cell of every board is contiguous, at
+ * cell * N + board, with a ghost row of GHOST_COLOR after the last cell for neighbour
+ * lookups that leave the board. Every operation is one branch-light pass over the
+ * boards.
+ *
+ * Per action the batch precomputes the row offsets (cell * N) of the cycle's cells and
+ * of the cells the reward looks at, so a step is a fixed set of independent loads at
+ * row offset + board instead of chains of neighbour lookups.
+ *
+ * Actions index the moves of the TriangleTable the Cursor walks: action a turns triangle
+ * a / 2, clockwise for even a and counter-clockwise for odd a.
+ */
+class BoardBatch
+{
+    // Per triangle cell, per axis: the two cells forward and the two cells backward.
+    using RewardStencil = std::array<std::array<std::array<std::uint32_t, 4>, 3>, 3>;
+
+    size_t boardCount;
+    size_t cellCount;
+    TriangleTable triangles;
+    std::vector<PaletteIndex> colors;
+    // Row offsets, per action for the cycles and per triangle for the stencils.
+    std::vector<std::array<std::uint32_t, 3>> actionRows;
+    std::vector<RewardStencil> stencilRows;
+
+    void buildRows(const NeighbourTable &neighbours);
+    std::uint32_t matchedCells(std::uint32_t action, size_t board) const;
+
+public:
+    // Throws when the batch has more cells than 32-bit row offsets reach.
+    template <typename Layout>
+    BoardBatch(const Layout &layout, size_t boardCount_in)
+        : boardCount(boardCount_in), cellCount(layout.size()), triangles(layout),
+          colors((layout.size() + 1) * boardCount_in, 0)
+    {
+        std::fill(colors.begin() + static_cast<std::ptrdiff_t>(cellCount * boardCount), colors.end(), GHOST_COLOR);
+        buildRows(NeighbourTable(layout));
+    }
+
+    size_t size() const { return boardCount; }
+    size_t getCellCount() const { return cellCount; }
+    size_t getActionCount() const { return triangles.size() * 2; }
+    const TriangleTable &getTriangles() const { return triangles; }
+
+    // The colour block, cell major with the ghost row last.
+    std::span<const PaletteIndex> getColors() const { return colors; }
+
+    static TriangleMove actionMove(std::uint32_t action)
+    {
+        return TriangleMove{action / 2, action % 2 == 0 ? Turn::Clockwise : Turn::CounterClockwise};
+    }
+
+    // Fills every board with random colours, reproducibly from the seed.
+    void randomize(std::uint64_t seed);
+
+    // Copies a board's colours in or out, one per cell in slot order.
+    void setBoard(size_t board, std::span<const PaletteIndex> boardColors);
+    void getBoard(size_t board, std::span<PaletteIndex> out) const;
+
+    // Applies actions[board] to every board.
+    void applyActions(std::span<const std::uint32_t> actions);
+
+    /**
+     * Scores the moves just applied: per board, the number of the turned triangle's cells
+     * that now lie in a straight run of three or more cells of one colour, 0 to 3.
+     */
+    void computeRewards(std::span<const std::uint32_t> actions, std::span<float> rewards) const;
+
+    // applyActions() followed by computeRewards().
+    void step(std::span<const std::uint32_t> actions, std::span<float> rewards);
+
+    // Writes every board's colours board major, out[board * getCellCount() + cell].
+    void observe(std::span<PaletteIndex> out) const;
+    // The same for boards [firstBoard, firstBoard + count), out[(board - firstBoard) * getCellCount() + cell].
+    void observe(size_t firstBoard, size_t count, std::span<PaletteIndex> out) const;
+};
@@ -0,0 +1,273 @@
+#include "board_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::runtime_error boardError(const std::filesystem::path &path, const char *what)
+    {
+        return std::runtime_error("board file " + path.string() + ": " + what);
+    }
+
+    // Checks the header against the file length, so the cells can be read without checks.
+    void validate(const std::filesystem::path &path, const BoardFileHeader &header, size_t length)
+    {
+        if (header.magic != BOARD_FILE_MAGIC)
+        {
+            throw boardError(path, "not a board file");
+        }
+        if (header.version != BOARD_FILE_VERSION)
+        {
+            throw boardError(path, "unsupported version");
+        }
+        if (header.bitsPerCell != BOARD_FILE_BITS)
+        {
+            throw boardError(path, "unsupported bits per cell");
+        }
+        if (header.shape != BoardShape::Hexagon && header.shape != BoardShape::Spiral)
+        {
+            throw boardError(path, "unknown shape");
+        }
+        if (header.paletteSize == 0 || header.paletteSize > PALETTE_SIZE)
+        {
+            throw boardError(path, "palette does not fit the game's");
+        }
+        // Radii past this have more cells than fit an int slot.
+        if (header.radius > 26000 ||
+            header.cellCount != static_cast<std::uint64_t>(hexagonCellCount(static_cast<int>(header.radius))))
+        {
+            throw boardError(path, "cell count does not match the radius");
+        }
+        const size_t words = PackedColorsView<BOARD_FILE_BITS>::wordCount(header.cellCount);
+        if (length < sizeof(BoardFileHeader) + words * sizeof(std::uint64_t))
+        {
+            throw boardError(path, "file is cut short");
+        }
+    }
+}
+
+void writeBoardFile(const std::filesystem::path &path, const BoardFileHeader &header,
+                    std::span<const std::uint64_t> words)
+{
+    std::FILE *file = std::fopen(path.string().c_str(), "wb");
+    if (!file)
+    {
+        throw boardError(path, "cannot be created");
+    }
+    const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         std::fwrite(words.data(), sizeof(std::uint64_t), words.size(), file) == words.size();
+    if (std::fclose(file) != 0 || !written)
+    {
+        throw boardError(path, "cannot be written");
+    }
+}
+
+void saveBoard(const std::filesystem::path &path, const PackedHexMap<BOARD_FILE_BITS> &board, std::uint64_t seed)
+{
+    BoardFileHeader header;
+    header.shape = BoardShape::Hexagon;
+    header.radius = static_cast<std::uint32_t>(board.getRadius());
+    header.cellCount = board.size();
+    header.seed = seed;
+    writeBoardFile(path, header, board.getColors().getWords());
+}
+
+MappedBoard::MappedBoard(const std::filesystem::path &path) : filePath(path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw boardError(path, "cannot be opened");
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(BoardFileHeader)))
+    {
+        CloseHandle(file);
+        throw boardError(path, "file is cut short");
+    }
+    handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!handle)
+    {
+        throw boardError(path, "cannot be mapped");
+    }
+    data = static_cast<const std::byte *>(MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0));
+    if (!data)
+    {
+        CloseHandle(handle);
+        throw boardError(path, "cannot be mapped");
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        throw boardError(path, "cannot be opened");
+    }
+    struct stat status;
+    if (::fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(BoardFileHeader)))
+    {
+        ::close(file);
+        throw boardError(path, "file is cut short");
+    }
+    length = static_cast<size_t>(status.st_size);
+    void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive on its own.
+    ::close(file);
+    if (mapping == MAP_FAILED)
+    {
+        throw boardError(path, "cannot be mapped");
+    }
+    data = static_cast<const std::byte *>(mapping);
+#endif
+
+    std::memcpy(&header, data, sizeof(header));
+    try
+    {
+        validate(path, header, length);
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+    // Mappings are page aligned, so the words right after the 32 byte header are aligned too.
+    const size_t cellCount = static_cast<size_t>(header.cellCount);
+    colors = PackedColorsView<BOARD_FILE_BITS>(
+        std::span(reinterpret_cast<const std::uint64_t *>(data + sizeof(BoardFileHeader)),
+                  PackedColorsView<BOARD_FILE_BITS>::wordCount(cellCount)),
+        cellCount);
+
+    if (header.shape == BoardShape::Hexagon)
+    {
+        rowOffsets.resize(static_cast<size_t>(2 * getRadius() + 1));
+        hexagonRowOffsets(getRadius(), rowOffsets);
+    }
+}
+
+MappedBoard::~MappedBoard()
+{
+    unmap();
+}
+
+MappedBoard::MappedBoard(MappedBoard &&other) noexcept
+    : filePath(std::move(other.filePath)), data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)),
+      handle(std::exchange(other.handle, nullptr)), header(other.header), colors(std::exchange(other.colors, {})),
+      rowOffsets(std::move(other.rowOffsets))
+{
+}
+
+MappedBoard &MappedBoard::operator=(MappedBoard &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        filePath = std::move(other.filePath);
+        data = std::exchange(other.data, nullptr);
+        length = std::exchange(other.length, 0);
+        handle = std::exchange(other.handle, nullptr);
+        header = other.header;
+        colors = std::exchange(other.colors, {});
+        rowOffsets = std::move(other.rowOffsets);
+    }
+    return *this;
+}
+
+void MappedBoard::unmap()
+{
+    if (!data)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(handle);
+#else
+    ::munmap(const_cast<std::byte *>(data), length);
+#endif
+    data = nullptr;
+    length = 0;
+    handle = nullptr;
+}
+
+std::optional<size_t> MappedBoard::find(const Hex &hex) const
+{
+    if (!contains(hex))
+    {
+        return std::nullopt;
+    }
+    if (header.shape == BoardShape::Spiral)
+    {
+        return static_cast<size_t>(hexToSpiral(hex));
+    }
+    return static_cast<size_t>(rowOffsets[static_cast<size_t>(hex.r + getRadius())] + hex.q);
+}
+
+Cell MappedBoard::at(const Hex &hex) const
+{
+    auto slot = find(hex);
+    if (!slot)
+    {
+        throw std::out_of_range("MappedBoard: hex is outside of the board");
+    }
+    const PaletteIndex color = get(*slot);
+    if (color >= header.paletteSize)
+    {
+        throw boardError(filePath, "cell outside the palette");
+    }
+    return Cell(color);
+}
+
+std::vector<PaletteIndex> MappedBoard::unpackCells() const
+{
+    std::vector<PaletteIndex> unpacked(size());
+    colors.unpack(unpacked);
+    for (PaletteIndex color : unpacked)
+    {
+        if (color >= header.paletteSize)
+        {
+            throw boardError(filePath, "cell outside the palette");
+        }
+    }
+    return unpacked;
+}
+
+HexMap MappedBoard::toHexMap() const
+{
+    if (header.shape != BoardShape::Hexagon)
+    {
+        throw std::runtime_error("MappedBoard: not a hexagon board");
+    }
+    const std::vector<PaletteIndex> unpacked = unpackCells();
+    HexMap hexMap{HexagonLayout(getRadius())};
+    hexMap.assignColors(unpacked);
+    return hexMap;
+}
+
+SpiralHexMap MappedBoard::toSpiralHexMap() const
+{
+    if (header.shape != BoardShape::Spiral)
+    {
+        throw std::runtime_error("MappedBoard: not a spiral board");
+    }
+    const std::vector<PaletteIndex> unpacked = unpackCells();
+    SpiralHexMap hexMap{SpiralLayout(getRadius())};
+    hexMap.assignColors(unpacked);
+    return hexMap;
+}
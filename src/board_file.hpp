@@ -0,0 +1,134 @@
+#pragma once
+
+#include "hex.hpp"
+#include "hex_map.hpp"
+#include "packed_hex_map.hpp"
+#include "palette.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// The order cells are stored in, which is the slot order of the matching layout.
+enum class BoardShape : std::uint8_t
+{
+    // Row by row, as HexagonLayout, FixedHexagonLayout and PackedHexMap store them.
+    Hexagon,
+    // Ring by ring, as SpiralLayout stores them.
+    Spiral
+};
+
+const std::array<char, 4> BOARD_FILE_MAGIC{'H', 'E', 'X', 'B'};
+const std::uint16_t BOARD_FILE_VERSION{1};
+const std::uint8_t BOARD_FILE_BITS{2};
+
+/**
+ * The header every board file starts with. The packed colours follow right after it:
+ * BOARD_FILE_BITS a cell in 64-bit words as PackedColors lays them out, so a mapped file
+ * is read in place. Everything is little endian.
+ *
+ * The palette itself is not stored. Cells are indices into the game's fixed palette,
+ * which the front end maps to colours and the rules only compare, so there is nothing per
+ * board to save but paletteSize, the number of indices the board's cells may use.
+ */
+struct BoardFileHeader
+{
+    std::array<char, 4> magic = BOARD_FILE_MAGIC;
+    std::uint16_t version = BOARD_FILE_VERSION;
+    BoardShape shape = BoardShape::Hexagon;
+    std::uint8_t bitsPerCell = BOARD_FILE_BITS;
+    std::uint32_t radius = 0;
+    std::uint16_t paletteSize = PALETTE_SIZE;
+    std::uint16_t reserved = 0;
+    std::uint64_t cellCount = 0;
+    // The seed the board was generated from, 0 for boards made by hand.
+    std::uint64_t seed = 0;
+};
+
+static_assert(sizeof(BoardFileHeader) == 32, "the header is part of the file format");
+static_assert(std::endian::native == std::endian::little, "board files are read in place as little endian");
+static_assert(PALETTE_SIZE <= (1 << BOARD_FILE_BITS), "board files pack colours into BOARD_FILE_BITS");
+
+// Writes the header and the packed colours to a file, throws std::runtime_error when that fails.
+void writeBoardFile(const std::filesystem::path &path, const BoardFileHeader &header,
+                    std::span<const std::uint64_t> words);
+
+// Saves a hexagon or spiral board, generated from seed or 0.
+template <typename Layout>
+void saveBoard(const std::filesystem::path &path, const BasicHexMap<Layout> &hexMap, std::uint64_t seed = 0)
+{
+    static_assert(Layout::FIXED_SHAPE, "only hexagon and spiral boards have a file shape");
+    BoardFileHeader header;
+    header.shape = std::is_same_v<Layout, SpiralLayout> ? BoardShape::Spiral : BoardShape::Hexagon;
+    header.radius = static_cast<std::uint32_t>(hexMap.getLayout().getRadius());
+    header.cellCount = hexMap.size();
+    header.seed = seed;
+    PackedColors<BOARD_FILE_BITS> colors;
+    colors.assign(hexMap.getColors());
+    writeBoardFile(path, header, colors.getWords());
+}
+
+// Saves a packed board as is, without unpacking it.
+void saveBoard(const std::filesystem::path &path, const PackedHexMap<BOARD_FILE_BITS> &board, std::uint64_t seed = 0);
+
+/**
+ * A board file mapped into memory, read-only. The header is checked when the file is
+ * opened and the cells are read straight from the mapping as packed colours: there is no
+ * parse step and nothing is allocated per cell, so opening a board of millions of cells
+ * takes as long as mapping it. Pages of the file are read in by the OS on first access.
+ *
+ * Lookups by hex work as for the layout of the board's shape. toHexMap() and
+ * toSpiralHexMap() copy the board into a playable map. Only they and at() check the cells
+ * against the palette, so opening stays free of a scan; getColors() and get() return
+ * what the file holds.
+ */
+class MappedBoard
+{
+    std::filesystem::path filePath;
+    const std::byte *data = nullptr;
+    size_t length = 0;
+    // The file mapping object on Windows, unused elsewhere.
+    void *handle = nullptr;
+    BoardFileHeader header;
+    PackedColorsView<BOARD_FILE_BITS> colors;
+    // Per row (r + radius) of a hexagon board: the index of the row's first cell minus its first q.
+    std::vector<int> rowOffsets;
+
+    void unmap();
+    // The cells unpacked, throws std::runtime_error when one is outside the palette.
+    std::vector<PaletteIndex> unpackCells() const;
+
+public:
+    // Throws std::runtime_error when the file cannot be mapped or is not a valid board.
+    explicit MappedBoard(const std::filesystem::path &path);
+    ~MappedBoard();
+
+    MappedBoard(const MappedBoard &) = delete;
+    MappedBoard &operator=(const MappedBoard &) = delete;
+    MappedBoard(MappedBoard &&other) noexcept;
+    MappedBoard &operator=(MappedBoard &&other) noexcept;
+
+    const BoardFileHeader &getHeader() const { return header; }
+    BoardShape getShape() const { return header.shape; }
+    int getRadius() const { return static_cast<int>(header.radius); }
+    std::uint64_t getSeed() const { return header.seed; }
+    size_t size() const { return colors.size(); }
+
+    // The cells in storage order, straight from the mapping.
+    PackedColorsView<BOARD_FILE_BITS> getColors() const { return colors; }
+    PaletteIndex get(size_t slot) const { return colors.get(slot); }
+
+    bool contains(const Hex &hex) const { return hexLength(hex) <= getRadius(); }
+    std::optional<size_t> find(const Hex &hex) const;
+    Cell at(const Hex &hex) const;
+
+    // Copies the board into a map, throws std::runtime_error when the shape differs or a
+    // cell is outside the palette.
+    HexMap toHexMap() const;
+    SpiralHexMap toSpiralHexMap() const;
+};
@@ -0,0 +1,217 @@
+#include "cascade.hpp"
+#include <cstdint>
+
+void Cascade::buildLines(const NeighbourTable &neighbours)
+{
+    // Lines start at the cells with nothing below them and run against gravity until
+    // they leave the board. Holes in sparse boards start a new line above them.
+    const size_t ghost = neighbours.ghostIndex();
+    const auto up = static_cast<HexDirection>((static_cast<size_t>(gravity) + 3) % 6);
+    lineStarts.push_back(0);
+    for (size_t cell = 0; cell < ghost; cell++)
+    {
+        if (neighbours.neighbour(cell, gravity) != ghost)
+        {
+            continue;
+        }
+        for (size_t above = cell; above != ghost; above = neighbours.neighbour(above, up))
+        {
+            lineOf[above] = static_cast<std::uint32_t>(lineStarts.size() - 1);
+            lineCells.push_back(static_cast<std::uint32_t>(above));
+        }
+        lineStarts.push_back(static_cast<std::uint32_t>(lineCells.size()));
+    }
+    dirtyLines.resize(getLineCount());
+}
+
+void Cascade::clearWaves()
+{
+    cleared.clear();
+    clearedEnds.clear();
+    changedCells.clear();
+    changedColors.clear();
+    fallDistances.clear();
+    previousColors.clear();
+    changeEnds.clear();
+}
+
+void Cascade::compactLines(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> matched)
+{
+    for (std::uint32_t cell : matched)
+    {
+        clearing[cell] = true;
+        cleared.push_back(cell);
+        if (!dirtyLines[lineOf[cell]])
+        {
+            dirtyLines[lineOf[cell]] = true;
+            dirty.push_back(lineOf[cell]);
+        }
+    }
+    clearedEnds.push_back(static_cast<std::uint32_t>(cleared.size()));
+
+    // Survivors move down over the cleared cells below them, in order.
+    for (std::uint32_t line : dirty)
+    {
+        const std::span<const std::uint32_t> cells = getLine(line);
+        size_t write = 0;
+        for (size_t read = 0; read < cells.size(); read++)
+        {
+            if (clearing[cells[read]])
+            {
+                continue;
+            }
+            if (read != write)
+            {
+                changedCells.push_back(cells[write]);
+                changedColors.push_back(paddedColors[cells[read]]);
+                fallDistances.push_back(static_cast<std::uint32_t>(read - write));
+                previousColors.push_back(paddedColors[cells[write]]);
+            }
+            write++;
+        }
+        // What is left at the top refills from above the board, every new cell falling
+        // as far as the line has cleared cells. Marked here, coloured by chooseRefills().
+        for (size_t top = write; top < cells.size(); top++)
+        {
+            refillStates[cells[top]] = Refill::Pending;
+        }
+    }
+
+    refillBegin = changedCells.size();
+    for (std::uint32_t line : dirty)
+    {
+        const std::span<const std::uint32_t> cells = getLine(line);
+        size_t fall = 0;
+        for (std::uint32_t cell : cells)
+        {
+            fall += refillStates[cell] == Refill::Pending;
+        }
+        for (std::uint32_t cell : cells.last(fall))
+        {
+            changedCells.push_back(cell);
+            changedColors.push_back(GHOST_COLOR);
+            fallDistances.push_back(static_cast<std::uint32_t>(fall));
+            previousColors.push_back(paddedColors[cell]);
+        }
+        dirtyLines[line] = false;
+    }
+    changeEnds.push_back(static_cast<std::uint32_t>(changedCells.size()));
+
+    dirty.clear();
+    for (std::uint32_t cell : matched)
+    {
+        clearing[cell] = false;
+    }
+}
+
+void Cascade::markInPlace(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> matched)
+{
+    cleared.insert(cleared.end(), matched.begin(), matched.end());
+    clearedEnds.push_back(static_cast<std::uint32_t>(cleared.size()));
+    refillBegin = changedCells.size();
+    for (std::uint32_t cell : matched)
+    {
+        refillStates[cell] = Refill::Pending;
+        changedCells.push_back(cell);
+        changedColors.push_back(GHOST_COLOR);
+        fallDistances.push_back(0);
+        previousColors.push_back(paddedColors[cell]);
+    }
+    changeEnds.push_back(static_cast<std::uint32_t>(changedCells.size()));
+}
+
+void Cascade::chooseRefills(std::span<const PaletteIndex> paddedColors, Xoshiro256 &rng, bool repair)
+{
+    // Random starting colours for the refills, drawn in one go; reopened cells draw their
+    // own. Read by index, as reopening cells grows the change lists.
+    const size_t startCount = changedCells.size() - refillBegin;
+    fillPaletteIndices(rng, std::span(changedColors).subspan(refillBegin), PALETTE_SIZE);
+
+    // Cells still waiting for their refill count as empty, the ones refilled before
+    // with the colour they got.
+    auto colorOf = [&](std::uint32_t cell)
+    {
+        switch (refillStates[cell])
+        {
+        case Refill::Pending:
+            return GHOST_COLOR;
+        case Refill::Chosen:
+            return refillColors[cell];
+        default:
+            return paddedColors[cell];
+        }
+    };
+
+    // Takes a decided cell back to be decided again, adding it to the changes as an in
+    // place recolour when it was not refilled in this wave.
+    auto reopen = [&](std::uint32_t cell)
+    {
+        if (refillStates[cell] == Refill::None)
+        {
+            changedCells.push_back(cell);
+            changedColors.push_back(GHOST_COLOR);
+            fallDistances.push_back(0);
+            previousColors.push_back(paddedColors[cell]);
+        }
+        refillStates[cell] = Refill::Pending;
+        refillQueue.push_back(cell);
+    };
+
+    refillQueue.assign(changedCells.begin() + static_cast<std::ptrdiff_t>(refillBegin), changedCells.end());
+    const size_t minClusterSize = finder.getMinClusterSize();
+    for (size_t i = 0; i < refillQueue.size(); i++)
+    {
+        const std::uint32_t cell = refillQueue[i];
+        refillStates[cell] = Refill::Chosen;
+        // The colour giving the smallest cluster, counted only as far as the best so far,
+        // ties going to the first tried. Colours completing a cluster all count as tied, so
+        // no fill runs past minClusterSize cells. A cluster of one means no neighbour has
+        // the colour.
+        const PaletteIndex first = i < startCount ? changedColors[refillBegin + i]
+                                                  : static_cast<PaletteIndex>(rng() % PALETTE_SIZE);
+        PaletteIndex best = first;
+        size_t bestSize = minClusterSize;
+        for (size_t offset = 0; offset < PALETTE_SIZE && bestSize > 1; offset++)
+        {
+            refillColors[cell] = static_cast<PaletteIndex>((first + offset) % PALETTE_SIZE);
+            const size_t size = finder.clusterSize(cell, colorOf, bestSize);
+            if (size < bestSize)
+            {
+                best = refillColors[cell];
+                bestSize = size;
+            }
+        }
+
+        if (repair && bestSize >= minClusterSize)
+        {
+            best = latticeColors[cell];
+            for (std::uint32_t next : finder.getNeighbours()[cell])
+            {
+                if (colorOf(next) == best)
+                {
+                    reopen(next);
+                }
+            }
+        }
+        refillColors[cell] = best;
+    }
+
+    for (size_t i = refillBegin; i < changedCells.size(); i++)
+    {
+        changedColors[i] = refillColors[changedCells[i]];
+        refillStates[changedCells[i]] = Refill::None;
+    }
+    changeEnds.back() = static_cast<std::uint32_t>(changedCells.size());
+}
+
+CascadeWave Cascade::getWave(size_t wave) const
+{
+    const size_t clearedBegin = wave == 0 ? 0 : clearedEnds[wave - 1];
+    const size_t changeBegin = wave == 0 ? 0 : changeEnds[wave - 1];
+    const size_t changeCount = changeEnds[wave] - changeBegin;
+    return CascadeWave{std::span(cleared).subspan(clearedBegin, clearedEnds[wave] - clearedBegin),
+                       std::span(changedCells).subspan(changeBegin, changeCount),
+                       std::span(changedColors).subspan(changeBegin, changeCount),
+                       std::span(fallDistances).subspan(changeBegin, changeCount),
+                       std::span(previousColors).subspan(changeBegin, changeCount)};
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "hex.hpp"
+#include "hex_map.hpp"
+#include "match.hpp"
+#include "palette.hpp"
+#include "random.hpp"
+#include "rotation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+const size_t MAX_CASCADE_WAVES{100};
+
+// How a run ends when its falling waves still leave clusters after maxWaves waves.
+enum class CascadeEnd : std::uint8_t
+{
+    // Stops there, the clusters stay on the board.
+    Stop,
+    // Recolours the clusters left where they stand, in one more wave that never leaves
+    // a cluster, so the board always ends stable.
+    RecolourInPlace
+};
+
+// What one cascade wave did, as spans into the Cascade's change lists.
+struct CascadeWave
+{
+    // The matched cells the wave cleared.
+    std::span<const std::uint32_t> cleared;
+    // Every cell that got a new colour, the colour and how many cells it fell along the
+    // gravity direction to get there. A cell fell from its hex minus distance steps of
+    // gravity, which is off the board for refilled cells. Distance 0 means recoloured in
+    // place, as settle() and CascadeEnd::RecolourInPlace do.
+    std::span<const std::uint32_t> cells;
+    std::span<const PaletteIndex> colors;
+    std::span<const std::uint32_t> distances;
+    // The colour each changed cell had before the wave, to undo it.
+    std::span<const PaletteIndex> previousColors;
+};
+
+/**
+ * Clears matched clusters and lets the cells above fall into the gaps along a gravity
+ * direction, refilling the board from the top, wave after wave until no cluster is left
+ * or a wave limit is reached.
+ *
+ * The board is cut into lines along the gravity direction once, each stored bottom up.
+ * A wave compacts every line with a cleared cell in one pass, reading the surviving
+ * colours downwards, and writes all moves to the map in one batch, then all refills in
+ * another. The next wave only looks for clusters through the changed cells.
+ *
+ * Each refill takes the colour that gives it the smallest cluster, trying colours in
+ * palette order from a random one, so it avoids every neighbour's colour where it can
+ * and further waves come from falling cells as in most match-3 games. Purely random
+ * refills practically never settle: on a hexagon board a handful of new cells nearly
+ * always contains a cluster of three.
+ *
+ * Falling cells are another matter. A line that drops shifts against the lines next to
+ * it, and with three colours and clusters of three the shifted cells form new clusters
+ * faster than the waves clear them, so gravity alone rarely settles a board past a few
+ * rings; the cascade bench counts how often. run() stops after maxWaves waves and
+ * isStable() tells whether clusters were left.
+ *
+ * Callers that need a stable board opt into CascadeEnd::RecolourInPlace, a rule of its
+ * own rather than gravity: after maxWaves falling waves, the clusters left are recoloured
+ * where they stand in one more wave. When every colour would complete a cluster there, a
+ * cell takes its colour in the lattice's proper 3-colouring, (q - r) mod 3, which no
+ * neighbour shares in that colouring, and the neighbours that do hold that colour are
+ * reopened and decided again. Cells coloured that way are never reopened, so this ends,
+ * and the last cell decided in any cluster would have seen it whole, so no cluster
+ * survives. settle() is that wave alone.
+ *
+ * The change list of every wave is kept until the next run(), so the renderer can
+ * animate the waves one after another.
+ */
+class Cascade
+{
+    enum class Refill : std::uint8_t
+    {
+        None,
+        Pending,
+        Chosen
+    };
+
+    HexDirection gravity;
+    MatchFinder finder;
+    // The cells of every line, bottom up; line l is lineCells[lineStarts[l]..lineStarts[l + 1]).
+    std::vector<std::uint32_t> lineCells;
+    std::vector<std::uint32_t> lineStarts;
+    // Per cell, its line.
+    std::vector<std::uint32_t> lineOf;
+    // Per cell, whether the running wave clears it, and per line whether it compacts.
+    std::vector<bool> clearing;
+    std::vector<bool> dirtyLines;
+    std::vector<std::uint32_t> dirty;
+    // Per cell, whether the running wave refills it and with what, padded with the ghost.
+    std::vector<Refill> refillStates;
+    std::vector<PaletteIndex> refillColors;
+    // Per cell, its colour in the proper 3-colouring of the lattice, (q - r) mod 3.
+    std::vector<PaletteIndex> latticeColors;
+    // The cells still to be decided by chooseRefills(), in order.
+    std::vector<std::uint32_t> refillQueue;
+
+    // Change lists of every wave of the last run, wave after wave. Per wave the moves
+    // come first, then the refills from refillBegin on.
+    std::vector<std::uint32_t> cleared;
+    std::vector<std::uint32_t> clearedEnds;
+    std::vector<std::uint32_t> changedCells;
+    std::vector<PaletteIndex> changedColors;
+    std::vector<std::uint32_t> fallDistances;
+    std::vector<PaletteIndex> previousColors;
+    std::vector<std::uint32_t> changeEnds;
+    size_t refillBegin = 0;
+    bool stable = true;
+    bool recoloured = false;
+
+    void buildLines(const NeighbourTable &neighbours);
+    void clearWaves();
+    // Compacts the lines of the matched cells into the change list, refills still blank.
+    void compactLines(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> matched);
+    // Refills the matched cells where they are, nothing falls.
+    void markInPlace(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> matched);
+    // Picks the refill colours once the moves are on the board. With repair, cells no
+    // colour works for take their lattice colour and reopen the neighbours sharing it.
+    void chooseRefills(std::span<const PaletteIndex> paddedColors, Xoshiro256 &rng, bool repair);
+
+    // The first maxWaves waves fall, then the run ends as end says.
+    template <typename Layout>
+    size_t cascade(BasicHexMap<Layout> &hexMap, std::span<const std::uint32_t> matched, Xoshiro256 &rng,
+                   size_t maxWaves, CascadeEnd end)
+    {
+        recoloured = false;
+        while (!matched.empty())
+        {
+            const bool fall = getWaveCount() < maxWaves;
+            if (!fall && end == CascadeEnd::Stop)
+            {
+                break;
+            }
+            recoloured = !fall;
+            const size_t waveBegin = changedCells.size();
+            if (fall)
+            {
+                compactLines(hexMap.getPaddedColors(), matched);
+            }
+            else
+            {
+                markInPlace(hexMap.getPaddedColors(), matched);
+            }
+            hexMap.setColors(std::span(changedCells).subspan(waveBegin, refillBegin - waveBegin),
+                             std::span(changedColors).subspan(waveBegin, refillBegin - waveBegin));
+            chooseRefills(hexMap.getPaddedColors(), rng, !fall);
+            hexMap.setColors(std::span(changedCells).subspan(refillBegin),
+                             std::span(changedColors).subspan(refillBegin));
+            matched = finder.find(hexMap.getPaddedColors(), getWave(getWaveCount() - 1).cells);
+        }
+        stable = matched.empty();
+        return getWaveCount();
+    }
+
+public:
+    template <typename Layout>
+    Cascade(const Layout &layout, HexDirection gravity_in, size_t minClusterSize = MIN_CLUSTER_SIZE)
+        : gravity(gravity_in), finder(layout, minClusterSize), lineOf(layout.size()), clearing(layout.size()),
+          refillStates(layout.size() + 1, Refill::None), refillColors(layout.size() + 1, GHOST_COLOR)
+    {
+        static_assert(PALETTE_SIZE >= 3, "settle() relies on the lattice's 3-colouring");
+        buildLines(finder.getNeighbours());
+        latticeColors.reserve(layout.size());
+        for (const Hex &hex : layout.getHexes())
+        {
+            latticeColors.push_back(static_cast<PaletteIndex>(((hex.q - hex.r) % 3 + 3) % 3));
+        }
+    }
+
+    HexDirection getGravity() const { return gravity; }
+    size_t getLineCount() const { return lineStarts.size() - 1; }
+
+    // The cells of a line, from the bottom up.
+    std::span<const std::uint32_t> getLine(size_t line) const
+    {
+        return std::span(lineCells).subspan(lineStarts[line], lineStarts[line + 1] - lineStarts[line]);
+    }
+
+    /**
+     * Clears the clusters through the seed cells, say the cells of a rotation, and
+     * cascades until the board is stable or maxWaves waves fell, then ends as end says.
+     * Refills draw from rng, so the same board, seeds and generator state always cascade
+     * the same way. Returns the number of waves.
+     */
+    template <typename Layout>
+    size_t run(BasicHexMap<Layout> &hexMap, std::span<const std::uint32_t> seeds, Xoshiro256 &rng,
+               size_t maxWaves = MAX_CASCADE_WAVES, CascadeEnd end = CascadeEnd::Stop)
+    {
+        clearWaves();
+        return cascade(hexMap, finder.find(hexMap.getPaddedColors(), seeds), rng, maxWaves, end);
+    }
+
+    // Recolours every cluster on the board in place, nothing falls, in one wave. For
+    // freshly generated boards.
+    template <typename Layout>
+    size_t settle(BasicHexMap<Layout> &hexMap, Xoshiro256 &rng)
+    {
+        clearWaves();
+        return cascade(hexMap, finder.findAll(hexMap.getPaddedColors()), rng, 0, CascadeEnd::RecolourInPlace);
+    }
+
+    // Whether the last run left no cluster behind, and whether its last wave recoloured in place.
+    bool isStable() const { return stable; }
+    bool wasRecoloured() const { return recoloured; }
+
+    size_t getWaveCount() const { return changeEnds.size(); }
+    CascadeWave getWave(size_t wave) const;
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "flat_hash_map.hpp"
+#include "hex.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * Sparse map for unbounded worlds. The axial plane is cut into parallelogram chunks of
+ * 2^ChunkBits x 2^ChunkBits cells which are allocated on first write, so memory follows
+ * the touched area rather than the bounding radius. A small FlatHashMap directory maps
+ * chunk coordinates to chunks, and inside a chunk cells are indexed densely by their
+ * local (q, r).
+ *
+ * Every chunk links to its six neighbouring chunks, so stepping from a Position to a
+ * neighbouring cell never hashes, even when the step crosses a chunk boundary.
+ */
+template <typename T, int ChunkBits = 5>
+class ChunkedHexMap
+{
+public:
+    static constexpr int CHUNK_SIZE = 1 << ChunkBits;
+    static constexpr size_t CHUNK_CELLS = static_cast<size_t>(CHUNK_SIZE * CHUNK_SIZE);
+
+private:
+    static constexpr int LOCAL_MASK = CHUNK_SIZE - 1;
+
+    struct Chunk
+    {
+        HexKey coord;
+        size_t count = 0;
+        std::array<T, CHUNK_CELLS> cells{};
+        std::array<std::uint64_t, (CHUNK_CELLS + 63) / 64> occupied{};
+        // Indexed by HexDirection, in chunk coordinates. Null while not allocated.
+        std::array<Chunk *, 6> adjacent{};
+
+        bool has(size_t slot) const
+        {
+            return (occupied[slot / 64] >> (slot % 64)) & 1;
+        }
+    };
+
+    FlatHashMap<HexKey, std::unique_ptr<Chunk>> directory;
+    size_t count = 0;
+
+    static HexKey chunkCoord(const Hex &hex)
+    {
+        // Arithmetic shift, so negative coordinates floor into the chunk below.
+        return HexKey(hex.q >> ChunkBits, hex.r >> ChunkBits);
+    }
+
+    static size_t localSlot(const Hex &hex)
+    {
+        return static_cast<size_t>(((hex.r & LOCAL_MASK) << ChunkBits) | (hex.q & LOCAL_MASK));
+    }
+
+    Chunk *findChunk(const HexKey &coord) const
+    {
+        const std::unique_ptr<Chunk> *chunk = directory.find(coord);
+        return chunk ? chunk->get() : nullptr;
+    }
+
+    Chunk &allocateChunk(const HexKey &coord)
+    {
+        if (Chunk *existing = findChunk(coord))
+        {
+            return *existing;
+        }
+
+        auto chunk = std::make_unique<Chunk>();
+        chunk->coord = coord;
+        for (size_t direction = 0; direction < hex_directions.size(); direction++)
+        {
+            const Hex &offset = hex_directions[direction];
+            Chunk *other = findChunk(HexKey(coord.q() + offset.q, coord.r() + offset.r));
+            chunk->adjacent[direction] = other;
+            if (other)
+            {
+                // The opposite direction is three steps around.
+                other->adjacent[(direction + 3) % 6] = chunk.get();
+            }
+        }
+        return *directory.tryEmplace(coord, std::move(chunk)).first->get();
+    }
+
+    void releaseChunk(Chunk &chunk)
+    {
+        for (size_t direction = 0; direction < chunk.adjacent.size(); direction++)
+        {
+            if (Chunk *other = chunk.adjacent[direction])
+            {
+                other->adjacent[(direction + 3) % 6] = nullptr;
+            }
+        }
+        HexKey coord = chunk.coord;
+        directory.erase(coord);
+    }
+
+public:
+    // A cell located in the map: its chunk (null when not allocated) and slot within it.
+    struct Position
+    {
+        Hex hex;
+        Chunk *chunk;
+        size_t slot;
+    };
+
+    size_t size() const { return count; }
+    size_t chunkCount() const { return directory.size(); }
+
+    // Bytes held by chunks and the chunk directory.
+    size_t memoryUsage() const
+    {
+        return directory.size() * sizeof(Chunk) +
+               directory.capacity() * (sizeof(typename decltype(directory)::value_type) + 1);
+    }
+
+    Position locate(const Hex &hex) const
+    {
+        return {hex, findChunk(chunkCoord(hex)), localSlot(hex)};
+    }
+
+    // The neighbouring position, following chunk links instead of the directory.
+    Position neighbour(const Position &position, HexDirection direction) const
+    {
+        const Hex hex = hexNeighbour(position.hex, direction);
+        if (!position.chunk)
+        {
+            return locate(hex);
+        }
+
+        const Hex &offset = hexDirection(direction);
+        int localQ = (position.hex.q & LOCAL_MASK) + offset.q;
+        int localR = (position.hex.r & LOCAL_MASK) + offset.r;
+        int chunkQ = localQ < 0 ? -1 : (localQ > LOCAL_MASK ? 1 : 0);
+        int chunkR = localR < 0 ? -1 : (localR > LOCAL_MASK ? 1 : 0);
+
+        Chunk *chunk = position.chunk;
+        if (chunkQ != 0 || chunkR != 0)
+        {
+            // A hex step moves at most one chunk along q and r, and the combination is
+            // always one of the hex directions themselves.
+            for (size_t i = 0; i < hex_directions.size(); i++)
+            {
+                if (hex_directions[i].q == chunkQ && hex_directions[i].r == chunkR)
+                {
+                    chunk = chunk->adjacent[i];
+                    break;
+                }
+            }
+        }
+        return {hex, chunk, localSlot(hex)};
+    }
+
+    const T *find(const Position &position) const
+    {
+        if (!position.chunk || !position.chunk->has(position.slot))
+        {
+            return nullptr;
+        }
+        return &position.chunk->cells[position.slot];
+    }
+
+    const T *find(const Hex &hex) const
+    {
+        return find(locate(hex));
+    }
+
+    bool contains(const Hex &hex) const
+    {
+        return find(hex) != nullptr;
+    }
+
+    const T &at(const Hex &hex) const
+    {
+        const T *value = find(hex);
+        if (!value)
+        {
+            throw std::out_of_range("ChunkedHexMap: no cell at hex");
+        }
+        return *value;
+    }
+
+    void insert(const Hex &hex, const T &value)
+    {
+        Chunk &chunk = allocateChunk(chunkCoord(hex));
+        size_t slot = localSlot(hex);
+        if (!chunk.has(slot))
+        {
+            chunk.occupied[slot / 64] |= std::uint64_t{1} << (slot % 64);
+            chunk.count++;
+            count++;
+        }
+        chunk.cells[slot] = value;
+    }
+
+    // Removes the cell, releasing its chunk once the chunk is empty.
+    bool erase(const Hex &hex)
+    {
+        Position position = locate(hex);
+        if (!find(position))
+        {
+            return false;
+        }
+        Chunk &chunk = *position.chunk;
+        chunk.occupied[position.slot / 64] &= ~(std::uint64_t{1} << (position.slot % 64));
+        chunk.cells[position.slot] = T();
+        chunk.count--;
+        count--;
+        if (chunk.count == 0)
+        {
+            releaseChunk(chunk);
+        }
+        return true;
+    }
+
+    // Calls f(hex, value) for every cell, chunk by chunk.
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        for (const auto &[coord, chunk] : directory)
+        {
+            const int baseQ = coord.q() << ChunkBits;
+            const int baseR = coord.r() << ChunkBits;
+            for (size_t word = 0; word < chunk->occupied.size(); word++)
+            {
+                for (std::uint64_t bits = chunk->occupied[word]; bits != 0; bits &= bits - 1)
+                {
+                    size_t slot = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                    int q = baseQ + static_cast<int>(slot & LOCAL_MASK);
+                    int r = baseR + static_cast<int>(slot >> ChunkBits);
+                    f(Hex(q, r, -q - r), chunk->cells[slot]);
+                }
+            }
+        }
+    }
+};
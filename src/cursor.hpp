@@ -0,0 +1,50 @@
+#pragma once
+
+#include "hex.hpp"
+#include "rotation.hpp"
+#include <array>
+#include <cstdint>
+
+// The triangle the player rotates, stepping between the rotation sites of a TriangleTable.
+class Cursor
+{
+    const TriangleTable *triangles;
+    std::uint32_t triangle;
+
+public:
+    Cursor(const TriangleTable &triangles_in, std::uint32_t triangle_in) : triangles(&triangles_in), triangle(triangle_in) {}
+
+    std::uint32_t getTriangle() const { return triangle; }
+    const std::array<Hex, 3> &getHexes() const { return triangles->getHexes(triangle); }
+    const Point &getPivot() const { return triangles->getPivot(triangle); }
+
+    void moveUp()
+    {
+        move(CursorMove::Up);
+    }
+
+    void moveDown()
+    {
+        move(CursorMove::Down);
+    }
+
+    void moveLeft()
+    {
+        move(CursorMove::Left);
+    }
+
+    void moveRight()
+    {
+        move(CursorMove::Right);
+    }
+
+    // Stays put when the move would take the triangle off the board.
+    void move(CursorMove direction)
+    {
+        std::uint32_t next = triangles->move(triangle, direction);
+        if (next != TriangleTable::NO_TRIANGLE)
+        {
+            triangle = next;
+        }
+    }
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/**
+ * Open addressing hash map with linear probing over a power-of-two table. Keys and values
+ * are stored inline in one array, so a lookup is a hash, a mask and a short forward scan
+ * over neighbouring slots. Erase shifts the following entries back instead of leaving
+ * tombstones, so probe sequences never grow from churn.
+ *
+ * The hash must spread its bits well, since only the low bits select the home slot.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap
+{
+public:
+    using value_type = std::pair<Key, Value>;
+
+private:
+    std::vector<value_type> slots;
+    std::vector<std::uint8_t> used;
+    size_t count = 0;
+    size_t mask = 0;
+    Hash hasher;
+
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    size_t home(const Key &key) const
+    {
+        return hasher(key) & mask;
+    }
+
+    size_t findSlot(const Key &key) const
+    {
+        if (slots.empty())
+        {
+            return NOT_FOUND;
+        }
+        for (size_t i = home(key);; i = (i + 1) & mask)
+        {
+            if (!used[i])
+            {
+                return NOT_FOUND;
+            }
+            if (slots[i].first == key)
+            {
+                return i;
+            }
+        }
+    }
+
+    // Keep the load factor at or below 3/4.
+    bool needsGrowth(size_t entries) const
+    {
+        return entries * 4 > slots.size() * 3;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<value_type> oldSlots(capacity);
+        std::vector<std::uint8_t> oldUsed(capacity, 0);
+        oldSlots.swap(slots);
+        oldUsed.swap(used);
+        mask = capacity - 1;
+
+        for (size_t i = 0; i < oldSlots.size(); i++)
+        {
+            if (oldUsed[i])
+            {
+                size_t slot = home(oldSlots[i].first);
+                while (used[slot])
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = std::move(oldSlots[i]);
+                used[slot] = 1;
+            }
+        }
+    }
+
+    template <bool IsConst>
+    class Iterator
+    {
+        using Map = std::conditional_t<IsConst, const FlatHashMap, FlatHashMap>;
+        Map *map;
+        size_t slot;
+
+        void skipUnused()
+        {
+            while (slot < map->slots.size() && !map->used[slot])
+            {
+                slot++;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const value_type &, value_type &>;
+        using pointer = std::conditional_t<IsConst, const value_type *, value_type *>;
+
+        Iterator() : map(nullptr), slot(0) {}
+        Iterator(Map *map_in, size_t slot_in) : map(map_in), slot(slot_in) { skipUnused(); }
+
+        reference operator*() const { return map->slots[slot]; }
+        pointer operator->() const { return &map->slots[slot]; }
+
+        Iterator &operator++()
+        {
+            slot++;
+            skipUnused();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator &other) const { return slot == other.slot; }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots.size()); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return slots.size(); }
+
+    void reserve(size_t entries)
+    {
+        size_t capacity = slots.empty() ? 16 : slots.size();
+        while (entries * 4 > capacity * 3)
+        {
+            capacity *= 2;
+        }
+        if (capacity != slots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    void clear()
+    {
+        slots.clear();
+        used.clear();
+        count = 0;
+        mask = 0;
+    }
+
+    Value *find(const Key &key)
+    {
+        size_t slot = findSlot(key);
+        return slot == NOT_FOUND ? nullptr : &slots[slot].second;
+    }
+
+    const Value *find(const Key &key) const
+    {
+        size_t slot = findSlot(key);
+        return slot == NOT_FOUND ? nullptr : &slots[slot].second;
+    }
+
+    bool contains(const Key &key) const
+    {
+        return findSlot(key) != NOT_FOUND;
+    }
+
+    /**
+     * Inserts the key with the given value unless it is already present.
+     *
+     * @return A pointer to the value stored for the key, and whether it was inserted.
+     */
+    std::pair<Value *, bool> tryEmplace(const Key &key, Value value)
+    {
+        if (slots.empty() || needsGrowth(count + 1))
+        {
+            reserve(count + 1);
+        }
+        size_t slot = home(key);
+        while (used[slot])
+        {
+            if (slots[slot].first == key)
+            {
+                return {&slots[slot].second, false};
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = {key, std::move(value)};
+        used[slot] = 1;
+        count++;
+        return {&slots[slot].second, true};
+    }
+
+    Value &operator[](const Key &key)
+    {
+        return *tryEmplace(key, Value()).first;
+    }
+
+    bool erase(const Key &key)
+    {
+        size_t hole = findSlot(key);
+        if (hole == NOT_FOUND)
+        {
+            return false;
+        }
+
+        // Pull back every following entry whose home slot does not lie between the
+        // hole and its current slot, so lookups never stop early at the hole.
+        for (size_t next = (hole + 1) & mask; used[next]; next = (next + 1) & mask)
+        {
+            size_t wanted = home(slots[next].first);
+            bool between = hole <= next ? (hole < wanted && wanted <= next)
+                                        : (hole < wanted || wanted <= next);
+            if (!between)
+            {
+                slots[hole] = std::move(slots[next]);
+                hole = next;
+            }
+        }
+        used[hole] = 0;
+        slots[hole] = value_type();
+        count--;
+        return true;
+    }
+};
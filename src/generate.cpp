@@ -0,0 +1,49 @@
+#include "generate.hpp"
+#include "parallel.hpp"
+#include <span>
+#include <utility>
+
+namespace
+{
+    // Stream i of the seed for row i, split off serially since jumping is cheap next to filling a row.
+    std::vector<Xoshiro256> rowStreams(size_t rowCount, std::uint64_t seed)
+    {
+        std::vector<Xoshiro256> streams;
+        streams.reserve(rowCount);
+        Xoshiro256 rng(seed);
+        for (size_t row = 0; row < rowCount; row++)
+        {
+            streams.push_back(rng);
+            rng.jump();
+        }
+        return streams;
+    }
+}
+
+std::vector<PaletteIndex> generateHexagonColors(int radius, std::uint64_t seed, unsigned threadCount)
+{
+    const size_t rowCount = static_cast<size_t>(2 * radius + 1);
+    std::vector<size_t> rowStarts(rowCount + 1, 0);
+    for (size_t row = 0; row < rowCount; row++)
+    {
+        const int r = static_cast<int>(row) - radius;
+        const int length = hexagonRowLastQ(radius, r) - hexagonRowFirstQ(radius, r) + 1;
+        rowStarts[row + 1] = rowStarts[row] + static_cast<size_t>(length);
+    }
+    std::vector<Xoshiro256> streams = rowStreams(rowCount, seed);
+
+    std::vector<PaletteIndex> colors(rowStarts.back());
+    parallelFor(rowCount, threadCount, [&](size_t row)
+                {
+        std::span<PaletteIndex> cells = std::span(colors).subspan(rowStarts[row], rowStarts[row + 1] - rowStarts[row]);
+        fillPaletteIndices(streams[row], cells, PALETTE_SIZE); });
+    return colors;
+}
+
+HexMap generateHexMap(int size, std::uint64_t seed, unsigned threadCount)
+{
+    HexagonLayout layout(size, DeferredRows{});
+    std::vector<Xoshiro256> streams = rowStreams(layout.getRowCount(), seed);
+    return HexMap(std::move(layout), threadCount, [&](size_t row, std::span<PaletteIndex> colors)
+                  { fillPaletteIndices(streams[row], colors, PALETTE_SIZE); });
+}
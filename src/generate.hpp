@@ -0,0 +1,36 @@
+#pragma once
+
+#include "hex_map.hpp"
+#include "random.hpp"
+#include <cstdint>
+#include <vector>
+
+// Gives every cell of the board a random colour, in one bulk pass over the board.
+template <typename Layout>
+void randomizeCells(BasicHexMap<Layout> &hexMap, Xoshiro256 &rng)
+{
+    std::vector<PaletteIndex> colors(hexMap.size());
+    fillPaletteIndices(rng, colors, PALETTE_SIZE);
+    hexMap.assignColors(colors);
+}
+
+/**
+ * Random colours for a hexagon board of the given radius, row by row (by r) as
+ * HexagonLayout and FixedHexagonLayout store them. Row i draws from stream i of the
+ * seed, so rows fill in parallel and the result is the same for every thread count.
+ *
+ * @param threadCount Threads to fill rows on, 0 for every hardware thread.
+ */
+std::vector<PaletteIndex> generateHexagonColors(int radius, std::uint64_t seed, unsigned threadCount = 0);
+
+// The board generateHexagonColors() colours, built in one parallel pass over its rows
+// that writes the hexes, colours and pixels straight into the map.
+HexMap generateHexMap(int size, std::uint64_t seed, unsigned threadCount = 0);
+
+template <int Radius>
+HexMapFixed<Radius> generateHexMapFixed(std::uint64_t seed)
+{
+    HexMapFixed<Radius> hexMap;
+    hexMap.assignColors(generateHexagonColors(Radius, seed, 1));
+    return hexMap;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// Finalizer from MurmurHash3. Every input bit affects every output bit, which keeps
+// power-of-two tables well spread even for small, dense integer keys.
+constexpr std::uint64_t mixBits(std::uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "hash.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <span>
+
+const int HEX_SIZE{16};
+
+// A position in pixels, relative to the centre of the board.
+struct Point
+{
+    float x;
+    float y;
+};
+
+class Hex
+{
+public:
+    int q;
+    int r;
+    int s;
+
+    constexpr Hex(int q_in, int r_in, int s_in)
+        : q(q_in), r(r_in), s(s_in)
+    {
+        // Ensure the constraint is checked at compile time if possible
+        assert(q + r + s == 0 && "Invalid Hex: q + r + s must equal 0");
+    }
+
+    bool operator==(const Hex &other) const
+    {
+        return q == other.q && r == other.r;
+    }
+
+    Point toPixel() const
+    {
+        return {
+            HEX_SIZE * ((std::sqrt(3.0f) * static_cast<float>(q)) + ((std::sqrt(3.0f) / 2) * static_cast<float>(r))),
+            HEX_SIZE * ((3.0f / 2) * static_cast<float>(r))};
+    }
+};
+
+constexpr Hex hexAdd(const Hex &a, const Hex &b)
+{
+    return {a.q + b.q, a.r + b.r, a.s + b.s};
+}
+
+constexpr Hex hexSubtract(const Hex &a, const Hex &b)
+{
+    return {a.q - b.q, a.r - b.r, a.s - b.s};
+}
+
+constexpr Hex hexMultiply(const Hex &a, int scalar)
+{
+    return {a.q * scalar, a.r * scalar, a.s * scalar};
+}
+
+constexpr int hexLength(const Hex &hex)
+{
+    return int((abs(hex.q) + abs(hex.r) + abs(hex.s)) / 2);
+}
+
+constexpr int hexDistance(const Hex &a, const Hex &b)
+{
+    return hexLength(hexSubtract(a, b));
+}
+
+enum class HexDirection
+{
+    East,      // right  (1, 0, -1)
+    SouthEast, // up-right (1, -1, 0)
+    SouthWest, // up-left (0, -1, 1)
+    West,      // left (-1, 0, 1)
+    NorthWest, // down-left (-1, 1, 0)
+    NorthEast  // down-right (0, 1, -1)
+};
+
+constexpr std::array<Hex, 6> hex_directions = {
+    Hex(1, 0, -1), Hex(1, -1, 0), Hex(0, -1, 1),
+    Hex(-1, 0, 1), Hex(-1, 1, 0), Hex(0, 1, -1)};
+
+constexpr const Hex &hexDirection(HexDirection direction)
+{
+    return hex_directions[(size_t)direction];
+}
+
+constexpr Hex hexNeighbour(const Hex &hex, HexDirection direction)
+{
+    return hexAdd(hex, hexDirection(direction));
+}
+
+// Number of cells in a hexagon shaped board.
+constexpr int hexagonCellCount(int radius)
+{
+    return 3 * radius * (radius + 1) + 1;
+}
+
+// First and last q of row r in a hexagon shaped board.
+constexpr int hexagonRowFirstQ(int radius, int r)
+{
+    return std::max(-radius, -r - radius);
+}
+
+constexpr int hexagonRowLastQ(int radius, int r)
+{
+    return std::min(radius, -r + radius);
+}
+
+// Per row (r + radius) of a hexagon board stored row by row: the index of the row's first
+// cell minus its first q, so a hex is stored at offsets[r + radius] + q. offsets holds
+// 2 * radius + 1 rows.
+constexpr void hexagonRowOffsets(int radius, std::span<int> offsets)
+{
+    int next = 0;
+    for (int r = -radius; r <= radius; r++)
+    {
+        const int q1 = hexagonRowFirstQ(radius, r);
+        offsets[static_cast<size_t>(r + radius)] = next - q1;
+        next += hexagonRowLastQ(radius, r) - q1 + 1;
+    }
+}
+
+// The hex stored at the given slot of a hexagon board stored row by row.
+constexpr Hex hexagonHexAt(int radius, int index)
+{
+    int r = -radius;
+    for (;; r++)
+    {
+        int length = hexagonRowLastQ(radius, r) - hexagonRowFirstQ(radius, r) + 1;
+        if (index < length)
+        {
+            break;
+        }
+        index -= length;
+    }
+    int q = hexagonRowFirstQ(radius, r) + index;
+    return Hex(q, r, -q - r);
+}
+
+/*
+ * Spiral order: the centre first, then ring 1, ring 2 and so on. Ring k starts at
+ * k * NorthWest and walks k steps in each direction, East first. A hexagon of radius n
+ * is then exactly the first 3n(n + 1) + 1 indices, and every ring is a contiguous range.
+ */
+
+// Index of the first hex of the given ring.
+constexpr int spiralRingStart(int ring)
+{
+    return ring == 0 ? 0 : 3 * ring * (ring - 1) + 1;
+}
+
+constexpr int hexToSpiral(const Hex &hex)
+{
+    const int k = hexLength(hex);
+    if (k == 0)
+    {
+        return 0;
+    }
+
+    int side;
+    int step;
+    if (hex.r == k && hex.q < 0)
+    {
+        side = 0;
+        step = hex.q + k;
+    }
+    else if (hex.s == -k && hex.q < k)
+    {
+        side = 1;
+        step = hex.q;
+    }
+    else if (hex.q == k && hex.r > -k)
+    {
+        side = 2;
+        step = -hex.r;
+    }
+    else if (hex.r == -k && hex.q > 0)
+    {
+        side = 3;
+        step = k - hex.q;
+    }
+    else if (hex.s == k && hex.q > -k)
+    {
+        side = 4;
+        step = -hex.q;
+    }
+    else
+    {
+        side = 5;
+        step = hex.r;
+    }
+    return spiralRingStart(k) + side * k + step;
+}
+
+constexpr Hex spiralToHex(int index)
+{
+    if (index == 0)
+    {
+        return Hex(0, 0, 0);
+    }
+
+    // Ring k holds indices [3k(k - 1) + 1, 3k(k + 1) + 1), solve for k with an integer sqrt.
+    const long long radicand = 12LL * index - 3;
+    long long root = radicand;
+    for (long long next = (root + 1) / 2; next < root; next = (root + radicand / root) / 2)
+    {
+        root = next;
+    }
+    const int k = static_cast<int>((3 + root) / 6);
+
+    const int offset = index - spiralRingStart(k);
+    const int side = offset / k;
+    const int step = offset % k;
+    const Hex corner = hexMultiply(hex_directions[static_cast<size_t>((side + 4) % 6)], k);
+    return hexAdd(corner, hexMultiply(hex_directions[static_cast<size_t>(side)], step));
+}
+
+/**
+ * A Hex packed into one 64-bit integer, q in the upper and r in the lower 32 bits. s is
+ * implied by q + r + s == 0 and is not stored, so keys compare and hash as a single word.
+ */
+class HexKey
+{
+public:
+    std::uint64_t value;
+
+    constexpr HexKey() : value(0) {}
+
+    constexpr HexKey(int q, int r)
+        : value((static_cast<std::uint64_t>(static_cast<std::uint32_t>(q)) << 32) | static_cast<std::uint32_t>(r)) {}
+
+    constexpr explicit HexKey(const Hex &hex) : HexKey(hex.q, hex.r) {}
+
+    constexpr int q() const { return static_cast<int>(static_cast<std::uint32_t>(value >> 32)); }
+    constexpr int r() const { return static_cast<int>(static_cast<std::uint32_t>(value)); }
+
+    constexpr Hex toHex() const { return Hex(q(), r(), -q() - r()); }
+
+    constexpr bool operator==(const HexKey &other) const = default;
+};
+
+// Hash functions for Hex and HexKey, to allow them to be used in hash-based containers like std::unordered_map or FlatHashMap.
+namespace std
+{
+    template <>
+    struct hash<HexKey>
+    {
+        size_t operator()(const HexKey &key) const
+        {
+            return static_cast<size_t>(mixBits(key.value));
+        }
+    };
+
+    template <>
+    struct hash<Hex>
+    {
+        size_t operator()(const Hex &h) const
+        {
+            return hash<HexKey>{}(HexKey(h));
+        }
+    };
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "hex.hpp"
+#include "palette.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// A fixed size bitset over 64-bit words with the shifts the hex bitboards need.
+class Bitboard
+{
+    std::vector<std::uint64_t> words;
+
+public:
+    Bitboard() = default;
+    explicit Bitboard(size_t bits) : words((bits + 63) / 64, 0) {}
+
+    std::span<const std::uint64_t> getWords() const { return words; }
+    std::span<std::uint64_t> getWords() { return words; }
+
+    bool test(size_t bit) const { return (words[bit / 64] >> (bit % 64)) & 1; }
+    void set(size_t bit) { words[bit / 64] |= std::uint64_t{1} << (bit % 64); }
+    void reset(size_t bit) { words[bit / 64] &= ~(std::uint64_t{1} << (bit % 64)); }
+
+    size_t count() const
+    {
+        size_t total = 0;
+        for (std::uint64_t word : words)
+        {
+            total += static_cast<size_t>(std::popcount(word));
+        }
+        return total;
+    }
+
+    Bitboard &operator&=(const Bitboard &other)
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    Bitboard &operator|=(const Bitboard &other)
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    // Word i of shiftedDown(n), without building the shifted board.
+    std::uint64_t wordShiftedDown(size_t i, size_t n) const
+    {
+        const size_t wordShift = n / 64;
+        const size_t bitShift = n % 64;
+        if (i + wordShift >= words.size())
+        {
+            return 0;
+        }
+        std::uint64_t word = words[i + wordShift] >> bitShift;
+        if (bitShift != 0 && i + wordShift + 1 < words.size())
+        {
+            word |= words[i + wordShift + 1] << (64 - bitShift);
+        }
+        return word;
+    }
+
+    // Word i of shiftedUp(n), without building the shifted board.
+    std::uint64_t wordShiftedUp(size_t i, size_t n) const
+    {
+        const size_t wordShift = n / 64;
+        const size_t bitShift = n % 64;
+        if (i < wordShift)
+        {
+            return 0;
+        }
+        std::uint64_t word = words[i - wordShift] << bitShift;
+        if (bitShift != 0 && i > wordShift)
+        {
+            word |= words[i - wordShift - 1] >> (64 - bitShift);
+        }
+        return word;
+    }
+
+    // Bit i of the result is bit i + n of this board, zeros shift in at the top.
+    Bitboard shiftedDown(size_t n) const
+    {
+        Bitboard result(words.size() * 64);
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            result.words[i] = wordShiftedDown(i, n);
+        }
+        return result;
+    }
+
+    // Bit i + n of the result is bit i of this board, bits shifted past the end are lost.
+    Bitboard shiftedUp(size_t n) const
+    {
+        Bitboard result(words.size() * 64);
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            result.words[i] = wordShiftedUp(i, n);
+        }
+        return result;
+    }
+
+    // Calls f(bit) for every set bit, in increasing order.
+    template <typename F>
+    void forEachSetBit(F &&f) const
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            for (std::uint64_t word = words[i]; word != 0; word &= word - 1)
+            {
+                f(i * 64 + static_cast<size_t>(std::countr_zero(word)));
+            }
+        }
+    }
+};
+
+/**
+ * One bitboard per palette colour over a hexagon board of the given radius. Bits are laid
+ * out as an axial rectangle, row by row (by r), with one always-clear guard column at the
+ * end of each row. Stepping along the three hex axes is then a shift by 1 (q), by the row
+ * width (r) or by the row width minus one (q - 1, r + 1), and the guard column keeps runs
+ * from wrapping into the next row. Whole-board match scans become a few shifts and ANDs
+ * per word, read straight from the colour boards without building shifted copies.
+ */
+class HexBitboards
+{
+    int radius;
+    size_t width;
+    size_t bitCount;
+    std::vector<Bitboard> colors;
+
+public:
+    HexBitboards(int radius_in, size_t paletteSize)
+        : radius(radius_in),
+          width(static_cast<size_t>(2 * radius_in + 2)),
+          bitCount(static_cast<size_t>(2 * radius_in + 1) * width),
+          colors(paletteSize, Bitboard(bitCount)) {}
+
+    // Builds the boards from matching hex and colour columns, like BasicHexMap's.
+    HexBitboards(int radius_in, size_t paletteSize, std::span<const Hex> hexes, std::span<const PaletteIndex> cellColors)
+        : HexBitboards(radius_in, paletteSize)
+    {
+        for (size_t i = 0; i < hexes.size(); i++)
+        {
+            colors[cellColors[i]].set(bitIndex(hexes[i]));
+        }
+    }
+
+    size_t getBitCount() const { return bitCount; }
+    const Bitboard &getColor(PaletteIndex color) const { return colors[color]; }
+
+    size_t bitIndex(const Hex &hex) const
+    {
+        return static_cast<size_t>(hex.r + radius) * width + static_cast<size_t>(hex.q + radius);
+    }
+
+    Hex hexAt(size_t bit) const
+    {
+        int q = static_cast<int>(bit % width) - radius;
+        int r = static_cast<int>(bit / width) - radius;
+        return Hex(q, r, -q - r);
+    }
+
+    // Moves one cell between colour boards, two word writes.
+    void recolor(const Hex &hex, PaletteIndex from, PaletteIndex to)
+    {
+        size_t bit = bitIndex(hex);
+        colors[from].reset(bit);
+        colors[to].set(bit);
+    }
+
+    /**
+     * Keeps the boards in sync with a finished rotation of three cells, where each cell
+     * took the colour of the next one (see BasicHexMap::stepRotation).
+     *
+     * @param hexes The rotated cells, in the order passed to startRotation.
+     * @param before The colours of those cells before the rotation.
+     */
+    void applyRotation(const std::array<Hex, 3> &hexes, const std::array<PaletteIndex, 3> &before)
+    {
+        for (size_t i = 0; i < hexes.size(); i++)
+        {
+            recolor(hexes[i], before[i], before[(i + 1) % 3]);
+        }
+    }
+
+    // Every cell that is part of a straight run of three or more same coloured cells.
+    Bitboard runsOfThree() const
+    {
+        Bitboard matched(bitCount);
+        runsOfThree(matched);
+        return matched;
+    }
+
+    // runsOfThree() into a board of getBitCount() bits, so repeated scans allocate nothing.
+    void runsOfThree(Bitboard &matched) const
+    {
+        const std::array<size_t, 3> axes{1, width, width - 1};
+        const std::span<std::uint64_t> out = matched.getWords();
+        std::fill(out.begin(), out.end(), 0);
+        for (const Bitboard &board : colors)
+        {
+            const std::span<const std::uint64_t> words = board.getWords();
+            for (size_t step : axes)
+            {
+                // A cell is in a run when it matches the two cells after it, the ones on
+                // either side or the two before it.
+                for (size_t i = 0; i < words.size(); i++)
+                {
+                    const std::uint64_t after = board.wordShiftedDown(i, step);
+                    const std::uint64_t before = board.wordShiftedUp(i, step);
+                    out[i] |= words[i] & ((after & board.wordShiftedDown(i, 2 * step)) | (before & after) |
+                                          (before & board.wordShiftedUp(i, 2 * step)));
+                }
+            }
+        }
+    }
+};
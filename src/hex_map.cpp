@@ -0,0 +1,66 @@
+#include "hex_map.hpp"
+
+HexagonLayout::HexagonLayout(int radius_in) : HexagonLayout(radius_in, DeferredRows{})
+{
+    for (size_t row = 0; row < getRowCount(); row++)
+    {
+        writeRow(row);
+    }
+}
+
+HexagonLayout::HexagonLayout(int radius_in, DeferredRows) : radius(radius_in)
+{
+    rowOffsets.resize(static_cast<size_t>(2 * radius + 1));
+    hexagonRowOffsets(radius, rowOffsets);
+    hexes.assign(static_cast<size_t>(hexagonCellCount(radius)), Hex(0, 0, 0));
+}
+
+void HexagonLayout::writeRow(size_t row)
+{
+    const int r = static_cast<int>(row) - radius;
+    const auto [first, last] = getRow(row);
+    int q = hexagonRowFirstQ(radius, r);
+    for (size_t i = first; i < last; i++, q++)
+    {
+        hexes[i] = Hex(q, r, -q - r);
+    }
+}
+
+size_t HexagonLayout::insert(const Hex &hex)
+{
+    auto found = find(hex);
+    if (!found)
+    {
+        throw std::out_of_range("HexagonLayout: hex is outside of the board");
+    }
+    return *found;
+}
+
+SpiralLayout::SpiralLayout(int radius_in) : radius(radius_in)
+{
+    hexes.reserve(static_cast<size_t>(spiralRingStart(radius + 1)));
+    for (int i = 0; i < spiralRingStart(radius + 1); i++)
+    {
+        hexes.push_back(spiralToHex(i));
+    }
+}
+
+size_t SpiralLayout::insert(const Hex &hex)
+{
+    auto found = find(hex);
+    if (!found)
+    {
+        throw std::out_of_range("SpiralLayout: hex is outside of the board");
+    }
+    return *found;
+}
+
+size_t SparseLayout::insert(const Hex &hex)
+{
+    auto [index, inserted] = indices.tryEmplace(HexKey(hex), static_cast<std::uint32_t>(hexes.size()));
+    if (inserted)
+    {
+        hexes.push_back(hex);
+    }
+    return *index;
+}
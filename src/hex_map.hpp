@@ -0,0 +1,655 @@
+#pragma once
+
+#include "flat_hash_map.hpp"
+#include "hash.hpp"
+#include "hex.hpp"
+#include "palette.hpp"
+#include "parallel.hpp"
+#include "rotation.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+class Cell
+{
+public:
+    PaletteIndex color;
+    Cell() : color(0) {}
+    explicit Cell(PaletteIndex color_in) : color(color_in) {}
+};
+
+// A cell sliding from one board slot to another while a rotation is animating.
+class CellAnimation
+{
+public:
+    size_t from = 0;
+    size_t to = 0;
+    float progress = 0.0f;
+
+    CellAnimation() = default;
+    CellAnimation(size_t from_in, size_t to_in) : from(from_in), to(to_in) {}
+
+    void step(float dt)
+    {
+        float newProgress = progress + dt * 4.0f;
+        if (newProgress > 1.0f)
+        {
+            newProgress = 1.0f;
+        }
+        progress = newProgress;
+    }
+
+    bool done() const
+    {
+        return progress >= 1.0f;
+    }
+};
+
+/*
+ * Layouts map each Hex of a board to a slot and back. They all provide size(), contains(),
+ * find(), insert() and getHexes() (every hex in slot order), a Column<T> container type
+ * for per-cell data and FIXED_SHAPE, which is false when insert() can add new slots.
+ */
+
+// Tag for building a layout whose rows are written later, possibly in parallel, with writeRow().
+struct DeferredRows
+{
+};
+
+/**
+ * Index layout for a hexagon shaped board. Cells are stored row by row (by r), each row
+ * holding a contiguous run of q values, so a Hex resolves to a slot in one flat array
+ * with a table lookup and an add instead of a hash.
+ */
+class HexagonLayout
+{
+    int radius;
+    // Per row (r + radius): the index of the row's first cell minus its first q.
+    std::vector<int> rowOffsets;
+    std::vector<Hex> hexes;
+
+public:
+    static constexpr bool FIXED_SHAPE = true;
+
+    template <typename T>
+    using Column = std::vector<T>;
+
+    explicit HexagonLayout(int radius_in);
+    // Every row sized but no hex written yet, each row must be written with writeRow() before use.
+    HexagonLayout(int radius_in, DeferredRows);
+
+    int getRadius() const { return radius; }
+    size_t size() const { return hexes.size(); }
+    std::span<const Hex> getHexes() const { return hexes; }
+
+    size_t getRowCount() const { return rowOffsets.size(); }
+
+    // Slots [first, last) of row (r + radius).
+    std::pair<size_t, size_t> getRow(size_t row) const
+    {
+        const int r = static_cast<int>(row) - radius;
+        return {static_cast<size_t>(rowOffsets[row] + hexagonRowFirstQ(radius, r)),
+                static_cast<size_t>(rowOffsets[row] + hexagonRowLastQ(radius, r) + 1)};
+    }
+
+    // Writes the hexes of a row. Rows share nothing, so different rows can be written in parallel.
+    void writeRow(size_t row);
+
+    bool contains(const Hex &hex) const
+    {
+        return hexLength(hex) <= radius;
+    }
+
+    // Unchecked, the hex must be on the board.
+    size_t index(const Hex &hex) const
+    {
+        return static_cast<size_t>(rowOffsets[static_cast<size_t>(hex.r + radius)] + hex.q);
+    }
+
+    std::optional<size_t> find(const Hex &hex) const
+    {
+        if (!contains(hex))
+        {
+            return std::nullopt;
+        }
+        return index(hex);
+    }
+
+    // Every slot already exists, inserting only resolves the index.
+    size_t insert(const Hex &hex);
+};
+
+/**
+ * Index layout for a hexagon shaped board stored in spiral order (see hexToSpiral): the
+ * centre, then ring after ring. Every ring and every radius-bounded disc around the centre
+ * is one contiguous range of slots.
+ */
+class SpiralLayout
+{
+    int radius;
+    std::vector<Hex> hexes;
+
+public:
+    static constexpr bool FIXED_SHAPE = true;
+
+    template <typename T>
+    using Column = std::vector<T>;
+
+    explicit SpiralLayout(int radius_in);
+
+    int getRadius() const { return radius; }
+    size_t size() const { return hexes.size(); }
+    std::span<const Hex> getHexes() const { return hexes; }
+
+    bool contains(const Hex &hex) const
+    {
+        return hexLength(hex) <= radius;
+    }
+
+    // Unchecked, the hex must be on the board.
+    size_t index(const Hex &hex) const
+    {
+        return static_cast<size_t>(hexToSpiral(hex));
+    }
+
+    std::optional<size_t> find(const Hex &hex) const
+    {
+        if (!contains(hex))
+        {
+            return std::nullopt;
+        }
+        return index(hex);
+    }
+
+    size_t insert(const Hex &hex);
+
+    // Slots [first, last) of the given ring.
+    std::pair<size_t, size_t> ring(int k) const
+    {
+        return {static_cast<size_t>(spiralRingStart(k)), static_cast<size_t>(spiralRingStart(k + 1))};
+    }
+};
+
+/**
+ * HexagonLayout for a radius known at compile time. Cell count, row offsets, the hexes,
+ * the spiral order and the neighbour table are all constexpr tables, columns are
+ * std::arrays, so a board using it lives without heap allocations and index math folds
+ * into constants.
+ */
+template <int Radius>
+class FixedHexagonLayout
+{
+public:
+    static constexpr bool FIXED_SHAPE = true;
+    static constexpr size_t CELL_COUNT = static_cast<size_t>(hexagonCellCount(Radius));
+    static constexpr size_t ROW_COUNT = static_cast<size_t>(2 * Radius + 1);
+
+    // One extra slot, for the ghost cell of the colour column.
+    template <typename T>
+    using Column = std::array<T, CELL_COUNT + 1>;
+
+    // Per row (r + Radius): the index of the row's first cell minus its first q.
+    static constexpr std::array<int, ROW_COUNT> ROW_OFFSETS = []
+    {
+        std::array<int, ROW_COUNT> offsets{};
+        hexagonRowOffsets(Radius, offsets);
+        return offsets;
+    }();
+
+    static constexpr std::array<Hex, CELL_COUNT> HEXES = []<size_t... I>(std::index_sequence<I...>)
+    {
+        return std::array<Hex, CELL_COUNT>{hexagonHexAt(Radius, static_cast<int>(I))...};
+    }(std::make_index_sequence<CELL_COUNT>());
+
+    // Slot of each spiral index, for ring and disc scans around the centre.
+    static constexpr std::array<std::uint32_t, CELL_COUNT> SPIRAL_ORDER = []
+    {
+        std::array<std::uint32_t, CELL_COUNT> order{};
+        for (size_t i = 0; i < CELL_COUNT; i++)
+        {
+            Hex hex = spiralToHex(static_cast<int>(i));
+            order[i] = static_cast<std::uint32_t>(ROW_OFFSETS[static_cast<size_t>(hex.r + Radius)] + hex.q);
+        }
+        return order;
+    }();
+
+    // Same contents as a NeighbourTable over this layout, ghost row included.
+    static constexpr std::array<std::array<std::uint32_t, 6>, CELL_COUNT + 1> NEIGHBOURS = []
+    {
+        std::array<std::array<std::uint32_t, 6>, CELL_COUNT + 1> table{};
+        for (size_t i = 0; i < CELL_COUNT; i++)
+        {
+            for (size_t direction = 0; direction < 6; direction++)
+            {
+                Hex hex = hexAdd(HEXES[i], hex_directions[direction]);
+                table[i][direction] = hexLength(hex) <= Radius
+                                          ? static_cast<std::uint32_t>(ROW_OFFSETS[static_cast<size_t>(hex.r + Radius)] + hex.q)
+                                          : static_cast<std::uint32_t>(CELL_COUNT);
+            }
+        }
+        table[CELL_COUNT].fill(static_cast<std::uint32_t>(CELL_COUNT));
+        return table;
+    }();
+
+    static constexpr int getRadius() { return Radius; }
+    static constexpr size_t size() { return CELL_COUNT; }
+    static constexpr std::span<const Hex> getHexes() { return HEXES; }
+
+    static constexpr bool contains(const Hex &hex)
+    {
+        return hexLength(hex) <= Radius;
+    }
+
+    // Unchecked, the hex must be on the board.
+    static constexpr size_t index(const Hex &hex)
+    {
+        return static_cast<size_t>(ROW_OFFSETS[static_cast<size_t>(hex.r + Radius)] + hex.q);
+    }
+
+    static constexpr std::optional<size_t> find(const Hex &hex)
+    {
+        if (!contains(hex))
+        {
+            return std::nullopt;
+        }
+        return index(hex);
+    }
+
+    size_t insert(const Hex &hex) const
+    {
+        auto found = find(hex);
+        if (!found)
+        {
+            throw std::out_of_range("FixedHexagonLayout: hex is outside of the board");
+        }
+        return *found;
+    }
+};
+
+/**
+ * Index layout for boards of any shape, for maps too sparse or unbounded for a dense
+ * array. Hexes get slots in insertion order and are found through a flat hash map.
+ */
+class SparseLayout
+{
+    FlatHashMap<HexKey, std::uint32_t> indices;
+    std::vector<Hex> hexes;
+
+public:
+    static constexpr bool FIXED_SHAPE = false;
+
+    template <typename T>
+    using Column = std::vector<T>;
+
+    size_t size() const { return hexes.size(); }
+    std::span<const Hex> getHexes() const { return hexes; }
+
+    bool contains(const Hex &hex) const
+    {
+        return indices.contains(HexKey(hex));
+    }
+
+    std::optional<size_t> find(const Hex &hex) const
+    {
+        const std::uint32_t *index = indices.find(HexKey(hex));
+        if (!index)
+        {
+            return std::nullopt;
+        }
+        return *index;
+    }
+
+    // Returns the slot of the hex, appending a new one when it is not in the layout yet.
+    size_t insert(const Hex &hex);
+};
+
+/**
+ * Per-cell slot indices of the six neighbours, in HexDirection order, for any layout.
+ * Neighbours off the board resolve to the ghost slot one past the last cell, which
+ * BasicHexMap keeps filled with GHOST_COLOR. The ghost's own neighbours are the ghost
+ * again, so scans and walks over the board read a harmless value instead of branching
+ * on the board edge. The table is a snapshot, rebuild it after a sparse map grows.
+ */
+class NeighbourTable
+{
+    std::vector<std::array<std::uint32_t, 6>> neighbours;
+
+public:
+    template <typename Layout>
+    explicit NeighbourTable(const Layout &layout)
+    {
+        const auto ghost = static_cast<std::uint32_t>(layout.size());
+        neighbours.reserve(layout.size() + 1);
+        for (const Hex &hex : layout.getHexes())
+        {
+            std::array<std::uint32_t, 6> &row = neighbours.emplace_back();
+            for (size_t direction = 0; direction < row.size(); direction++)
+            {
+                auto index = layout.find(hexAdd(hex, hex_directions[direction]));
+                row[direction] = index ? static_cast<std::uint32_t>(*index) : ghost;
+            }
+        }
+        neighbours.emplace_back();
+        neighbours.back().fill(ghost);
+    }
+
+    size_t ghostIndex() const { return neighbours.size() - 1; }
+
+    const std::array<std::uint32_t, 6> &operator[](size_t index) const
+    {
+        return neighbours[index];
+    }
+
+    size_t neighbour(size_t index, HexDirection direction) const
+    {
+        return neighbours[index][static_cast<size_t>(direction)];
+    }
+};
+
+/**
+ * The Zobrist key of a hex holding a colour. Keys derive from the hex coordinates rather
+ * than the slot, so the same board hashes the same in every layout and every process.
+ */
+inline std::uint64_t zobristKey(const Hex &hex, PaletteIndex color)
+{
+    return mixBits(HexKey(hex).value + 0x9e3779b97f4a7c15 * (static_cast<std::uint64_t>(color) + 1));
+}
+
+/**
+ * zobristKey() of every cell of a layout for every palette colour. BasicHexMap computes
+ * keys as cells change, which keeps a map at one byte a cell; loops that rotate one small
+ * board millions of times, like the solver's, pass a table to applyCycle() to skip the
+ * mixing instead.
+ */
+class ZobristTable
+{
+    std::vector<std::array<std::uint64_t, PALETTE_SIZE>> keys;
+
+public:
+    template <typename Layout>
+    explicit ZobristTable(const Layout &layout)
+    {
+        keys.reserve(layout.size());
+        for (const Hex &hex : layout.getHexes())
+        {
+            auto &cellKeys = keys.emplace_back();
+            for (size_t color = 0; color < cellKeys.size(); color++)
+            {
+                cellKeys[color] = zobristKey(hex, static_cast<PaletteIndex>(color));
+            }
+        }
+    }
+
+    size_t size() const { return keys.size(); }
+    size_t memoryUsage() const { return keys.size() * sizeof(keys[0]); }
+
+    const std::array<std::uint64_t, PALETTE_SIZE> &operator[](size_t index) const { return keys[index]; }
+};
+
+/**
+ * The board, stored as structure of arrays: one column per cell attribute, all in layout
+ * order. Scans over the board only touch the columns they need, and the handful of cells
+ * taking part in a rotation live in a small side table instead of in every cell.
+ *
+ * The Layout decides how a Hex maps to a slot in the columns: HexagonLayout for the dense
+ * hexagon boards the game uses, FixedHexagonLayout for the same with a compile-time
+ * radius, SpiralLayout for the same boards in ring order and SparseLayout for boards of
+ * arbitrary shape.
+ *
+ * The map keeps a Zobrist hash of its colours, the xor of zobristKey() over every cell,
+ * updated in O(1) as cells change so searches can deduplicate boards by getHash().
+ */
+template <typename Layout>
+class BasicHexMap
+{
+    Layout layout;
+    // Padded with the ghost slot at index size().
+    typename Layout::template Column<PaletteIndex> colors{};
+    // Cell centres relative to the board origin, computed once.
+    typename Layout::template Column<Point> pixels{};
+    // Valid while a rotation is running.
+    std::array<CellAnimation, 3> animations{};
+    IndexCycle rotationCycle;
+    std::optional<std::array<Hex, 3>> rotation;
+    std::uint64_t hash = 0;
+
+    size_t indexOf(const Hex &hex) const
+    {
+        auto index = layout.find(hex);
+        if (!index)
+        {
+            throw std::out_of_range("HexMap: hex is outside of the board");
+        }
+        return *index;
+    }
+
+    // Keys are a single mixBits() away, cheaper than a cached column of PALETTE_SIZE keys
+    // per cell would be to build, copy and keep in cache.
+    std::uint64_t keyOf(size_t index) const
+    {
+        return zobristKey(layout.getHexes()[index], colors[index]);
+    }
+
+public:
+    explicit BasicHexMap(Layout layout_in = Layout()) : layout(std::move(layout_in))
+    {
+        if constexpr (requires { colors.resize(size_t{}); })
+        {
+            colors.resize(layout.size() + 1);
+            pixels.resize(layout.size());
+        }
+        std::ranges::fill(colors, 0);
+        colors[layout.size()] = GHOST_COLOR;
+        for (size_t i = 0; i < layout.size(); i++)
+        {
+            pixels[i] = layout.getHexes()[i].toPixel();
+        }
+        hash = computeHash();
+    }
+
+    /**
+     * Builds the map over a layout made with DeferredRows in one pass over its rows, on up
+     * to threadCount threads (0 for all of them). Per row the layout writes its hexes,
+     * fill(row, colors) writes the row's colours straight into the colour column, and the
+     * map adds the row's pixels and its share of the hash.
+     */
+    template <typename F>
+        requires requires(Layout &l) { l.writeRow(size_t{}); }
+    BasicHexMap(Layout layout_in, unsigned threadCount, F &&fill)
+        : layout(std::move(layout_in)), colors(layout.size() + 1), pixels(layout.size())
+    {
+        colors[layout.size()] = GHOST_COLOR;
+        std::vector<std::uint64_t> rowHashes(layout.getRowCount(), 0);
+        parallelFor(layout.getRowCount(), threadCount, [&](size_t row)
+                    {
+            layout.writeRow(row);
+            const auto [first, last] = layout.getRow(row);
+            fill(row, std::span(colors).subspan(first, last - first));
+            std::uint64_t rowHash = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                pixels[i] = layout.getHexes()[i].toPixel();
+                rowHash ^= keyOf(i);
+            }
+            rowHashes[row] = rowHash; });
+        for (std::uint64_t rowHash : rowHashes)
+        {
+            hash ^= rowHash;
+        }
+    }
+
+    size_t size() const { return layout.size(); }
+    bool contains(const Hex &hex) const { return layout.contains(hex); }
+    const Layout &getLayout() const { return layout; }
+
+    std::span<const Hex> getHexes() const { return layout.getHexes(); }
+    std::span<const PaletteIndex> getColors() const { return std::span(colors).first(size()); }
+    // The colours followed by the ghost slot, for lookups through a NeighbourTable.
+    std::span<const PaletteIndex> getPaddedColors() const { return std::span(colors).first(size() + 1); }
+    std::span<const Point> getPixels() const { return std::span(pixels).first(size()); }
+
+    std::span<const CellAnimation> getAnimations() const
+    {
+        return rotation ? std::span<const CellAnimation>(animations) : std::span<const CellAnimation>();
+    }
+
+    const auto &getRotation() const { return rotation; }
+    // The cycle of the running rotation, or of the last one once it completed.
+    const IndexCycle &getRotationCycle() const { return rotationCycle; }
+    bool hasRotation() const { return rotation.has_value(); }
+
+    std::uint64_t getHash() const { return hash; }
+
+    // Hashes the board from scratch, to verify the incrementally kept getHash().
+    std::uint64_t computeHash() const
+    {
+        std::uint64_t result = 0;
+        for (size_t i = 0; i < size(); i++)
+        {
+            result ^= keyOf(i);
+        }
+        return result;
+    }
+
+    bool isAnimating(size_t index) const
+    {
+        return std::ranges::any_of(getAnimations(), [index](const CellAnimation &animation)
+                                   { return animation.from == index; });
+    }
+
+    void insert(const Hex &hex, const Cell &cell)
+    {
+        size_t index = layout.insert(hex);
+        bool added = false;
+        if constexpr (!Layout::FIXED_SHAPE)
+        {
+            if (index == pixels.size())
+            {
+                pixels.push_back(hex.toPixel());
+                colors.push_back(GHOST_COLOR);
+                added = true;
+            }
+        }
+        if (!added)
+        {
+            hash ^= keyOf(index);
+        }
+        colors[index] = cell.color;
+        hash ^= keyOf(index);
+    }
+
+    // Overwrites every cell's colour at once, newColors holds one per cell in slot order.
+    void assignColors(std::span<const PaletteIndex> newColors)
+    {
+        if (newColors.size() != size())
+        {
+            throw std::invalid_argument("HexMap: one colour per cell expected");
+        }
+        std::ranges::copy(newColors, colors.begin());
+        hash = computeHash();
+    }
+
+    /**
+     * Overwrites the colours of some cells at once, cells[i] getting newColors[i], keeping
+     * the hash up to date cell by cell instead of rehashing the board.
+     */
+    void setColors(std::span<const std::uint32_t> cells, std::span<const PaletteIndex> newColors)
+    {
+        if (newColors.size() != cells.size())
+        {
+            throw std::invalid_argument("HexMap: one colour per cell expected");
+        }
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            hash ^= keyOf(cells[i]);
+            colors[cells[i]] = newColors[i];
+            hash ^= keyOf(cells[i]);
+        }
+    }
+
+    // The permutation that rotates the three hexes, throws when one is off the board.
+    IndexCycle getCycle(const std::array<Hex, 3> &hexes) const
+    {
+        return IndexCycle(static_cast<std::uint32_t>(indexOf(hexes[0])), static_cast<std::uint32_t>(indexOf(hexes[1])),
+                          static_cast<std::uint32_t>(indexOf(hexes[2])));
+    }
+
+    // Rotates instantly, without animating. Apply cycle.inverse() to undo.
+    void applyCycle(const IndexCycle &cycle)
+    {
+        const std::uint32_t cell0 = cycle.cells[0], cell1 = cycle.cells[1], cell2 = cycle.cells[2];
+        const PaletteIndex color0 = colors[cell0], color1 = colors[cell1], color2 = colors[cell2];
+        // All six keys from the colours read up front, instead of rehashing after the writes.
+        const std::span<const Hex> hexes = layout.getHexes();
+        hash ^= zobristKey(hexes[cell0], color0) ^ zobristKey(hexes[cell1], color1) ^ zobristKey(hexes[cell2], color2) ^
+                zobristKey(hexes[cell0], color1) ^ zobristKey(hexes[cell1], color2) ^ zobristKey(hexes[cell2], color0);
+        cycle.apply(colors.data());
+    }
+
+    // applyCycle() reading the keys from a table built for this map's layout.
+    void applyCycle(const IndexCycle &cycle, const ZobristTable &keys)
+    {
+        const std::uint32_t cell0 = cycle.cells[0], cell1 = cycle.cells[1], cell2 = cycle.cells[2];
+        const PaletteIndex color0 = colors[cell0], color1 = colors[cell1], color2 = colors[cell2];
+        if (color0 >= PALETTE_SIZE || color1 >= PALETTE_SIZE || color2 >= PALETTE_SIZE)
+        {
+            applyCycle(cycle);
+            return;
+        }
+        const auto &keys0 = keys[cell0];
+        const auto &keys1 = keys[cell1];
+        const auto &keys2 = keys[cell2];
+        hash ^= keys0[color0] ^ keys1[color1] ^ keys2[color2] ^ keys0[color1] ^ keys1[color2] ^ keys2[color0];
+        cycle.apply(colors.data());
+    }
+
+    void startRotation(const std::array<Hex, 3> &hexes)
+    {
+        rotationCycle = getCycle(hexes);
+        rotation = hexes;
+        for (size_t i = 0; i < animations.size(); i++)
+        {
+            animations[i] = CellAnimation(rotationCycle.cells[i], rotationCycle.target(i));
+        }
+    }
+
+    // Advances the running rotation, returns true on the step that completes it.
+    bool stepRotation(float dt)
+    {
+        if (rotation)
+        {
+            bool done = true;
+            for (CellAnimation &animation : animations)
+            {
+                animation.step(dt);
+                done = done && animation.done();
+            }
+
+            if (done)
+            {
+                applyCycle(rotationCycle);
+                rotation.reset();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Cell at(const Hex &h) const
+    {
+        return Cell(colors[indexOf(h)]);
+    }
+};
+
+using HexMap = BasicHexMap<HexagonLayout>;
+using SpiralHexMap = BasicHexMap<SpiralLayout>;
+using SparseHexMap = BasicHexMap<SparseLayout>;
+
+template <int Radius>
+using HexMapFixed = BasicHexMap<FixedHexagonLayout<Radius>>;
@@ -0,0 +1,92 @@
+#include "journal.hpp"
+#include <algorithm>
+
+void Journal::truncate()
+{
+    if (position == entries.size())
+    {
+        return;
+    }
+    // Diffs are numbered in recording order, so the first dropped one is the oldest.
+    const auto firstDiff = std::find_if(entries.begin() + static_cast<std::ptrdiff_t>(position), entries.end(),
+                                        [](const Entry &entry)
+                                        { return entry.kind == EntryKind::Diff; });
+    if (firstDiff != entries.end())
+    {
+        diffEnds.resize(firstDiff->index);
+        const size_t cellCount = diffEnds.empty() ? 0 : diffEnds.back();
+        diffCells.resize(cellCount);
+        diffDeltas.resize(cellCount);
+    }
+    entries.resize(position);
+    while (keyframes.back().position > position)
+    {
+        keyframes.pop_back();
+    }
+}
+
+void Journal::push(const Entry &entry)
+{
+    entries.push_back(entry);
+    position++;
+}
+
+void Journal::addKeyframe(std::span<const PaletteIndex> colors)
+{
+    Keyframe &keyframe = keyframes.emplace_back();
+    keyframe.position = position;
+    keyframe.colors.assign(colors);
+}
+
+const Journal::Keyframe &Journal::keyframeBefore(size_t target) const
+{
+    const auto after = std::upper_bound(keyframes.begin(), keyframes.end(), target,
+                                        [](size_t value, const Keyframe &keyframe)
+                                        { return value < keyframe.position; });
+    return *(after - 1);
+}
+
+void Journal::recordWaves(const Cascade &cascade)
+{
+    truncate();
+    // Xors of before and after compose across waves, so every wave folds into one delta
+    // per cell.
+    for (size_t w = 0; w < cascade.getWaveCount(); w++)
+    {
+        const CascadeWave wave = cascade.getWave(w);
+        for (size_t i = 0; i < wave.cells.size(); i++)
+        {
+            const std::uint32_t cell = wave.cells[i];
+            if (deltas[cell] == 0)
+            {
+                touched.push_back(cell);
+            }
+            deltas[cell] ^= static_cast<PaletteIndex>(wave.previousColors[i] ^ wave.colors[i]);
+        }
+    }
+
+    // A cell can end up where it started, with a zero delta and nothing to store.
+    for (std::uint32_t cell : touched)
+    {
+        if (deltas[cell] != 0)
+        {
+            diffCells.push_back(cell);
+            diffDeltas.push_back(deltas[cell]);
+            deltas[cell] = 0;
+        }
+    }
+    touched.clear();
+    push(Entry{static_cast<std::uint32_t>(diffEnds.size()), EntryKind::Diff});
+    diffEnds.push_back(static_cast<std::uint32_t>(diffCells.size()));
+}
+
+size_t Journal::memoryUsage() const
+{
+    size_t keyframeBytes = 0;
+    for (const Keyframe &keyframe : keyframes)
+    {
+        keyframeBytes += keyframe.colors.memoryUsage();
+    }
+    return entries.size() * sizeof(Entry) + diffCells.size() * sizeof(std::uint32_t) +
+           diffDeltas.size() * sizeof(PaletteIndex) + diffEnds.size() * sizeof(std::uint32_t) + keyframeBytes;
+}
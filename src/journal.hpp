@@ -0,0 +1,207 @@
+#pragma once
+
+#include "cascade.hpp"
+#include "hex_map.hpp"
+#include "packed_hex_map.hpp"
+#include "palette.hpp"
+#include "rotation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+const size_t KEYFRAME_INTERVAL{256};
+
+/**
+ * Unlimited undo and redo for a board. Every rotation is kept as its triangle and turn,
+ * undone by applying the inverse cycle, and every cascade as a diff of the cells it
+ * changed: the cell and the xor of its colour before and after, so the same diff both
+ * undoes and redoes it. Recording after an undo drops the redo tail.
+ *
+ * Every KEYFRAME_INTERVAL entries the board is also stored whole, packed at two bits a
+ * cell, so jumpTo() restores the nearest keyframe instead of replaying the whole history
+ * when that is shorter. Jumping anywhere costs at most one keyframe restore and interval
+ * steps.
+ *
+ * Only palette colours are supported, as in the keyframes.
+ */
+class Journal
+{
+    static_assert(PALETTE_SIZE <= 4, "keyframes pack colours into two bits");
+
+    enum class EntryKind : std::uint8_t
+    {
+        Clockwise,
+        CounterClockwise,
+        Diff
+    };
+
+    // A rotation's triangle or a diff's index, 8 bytes.
+    struct Entry
+    {
+        std::uint32_t index;
+        EntryKind kind;
+    };
+
+    struct Keyframe
+    {
+        size_t position;
+        PackedColors<2> colors;
+    };
+
+    const TriangleTable *triangles;
+    size_t keyframeInterval;
+    std::vector<Entry> entries;
+    size_t position = 0;
+    // The cells and colour xors of every diff; diff d is diffCells[diffEnds[d - 1]..diffEnds[d]).
+    std::vector<std::uint32_t> diffCells;
+    std::vector<PaletteIndex> diffDeltas;
+    std::vector<std::uint32_t> diffEnds;
+    std::vector<Keyframe> keyframes;
+    // Per cell scratch for merging waves and applying diffs.
+    std::vector<PaletteIndex> deltas;
+    std::vector<std::uint32_t> touched;
+    std::vector<PaletteIndex> scratch;
+
+    // Drops everything after the current position, to record a new branch.
+    void truncate();
+    void push(const Entry &entry);
+    bool needsKeyframe() const { return position % keyframeInterval == 0 && keyframes.back().position < position; }
+    void addKeyframe(std::span<const PaletteIndex> colors);
+    // The last keyframe at or before the position.
+    const Keyframe &keyframeBefore(size_t target) const;
+
+    void recordWaves(const Cascade &cascade);
+
+    // Applies entry i, forwards when redoing and backwards when undoing.
+    template <typename Layout>
+    void replay(BasicHexMap<Layout> &hexMap, size_t i, bool forward)
+    {
+        const Entry &entry = entries[i];
+        if (entry.kind == EntryKind::Diff)
+        {
+            const size_t begin = entry.index == 0 ? 0 : diffEnds[entry.index - 1];
+            const auto cells = std::span(diffCells).subspan(begin, diffEnds[entry.index] - begin);
+            const auto colors = hexMap.getColors();
+            scratch.resize(cells.size());
+            for (size_t c = 0; c < cells.size(); c++)
+            {
+                scratch[c] = static_cast<PaletteIndex>(colors[cells[c]] ^ diffDeltas[begin + c]);
+            }
+            hexMap.setColors(cells, scratch);
+            return;
+        }
+        const bool clockwise = (entry.kind == EntryKind::Clockwise) == forward;
+        const IndexCycle &cycle = triangles->getCycle(entry.index);
+        hexMap.applyCycle(clockwise ? cycle : cycle.inverse());
+    }
+
+public:
+    template <typename Layout>
+    Journal(const BasicHexMap<Layout> &start, const TriangleTable &triangles_in,
+            size_t keyframeInterval_in = KEYFRAME_INTERVAL)
+        : triangles(&triangles_in), keyframeInterval(keyframeInterval_in), deltas(start.size(), 0)
+    {
+        if (keyframeInterval == 0)
+        {
+            throw std::invalid_argument("Journal: keyframe interval must be positive");
+        }
+        addKeyframe(start.getColors());
+    }
+
+    // Recorded entries, done and undone.
+    size_t size() const { return entries.size(); }
+    size_t getPosition() const { return position; }
+    bool canUndo() const { return position > 0; }
+    bool canRedo() const { return position < entries.size(); }
+    size_t getKeyframeCount() const { return keyframes.size(); }
+    size_t memoryUsage() const;
+
+    // Turns a triangle and records it.
+    template <typename Layout>
+    void rotate(BasicHexMap<Layout> &hexMap, const TriangleMove &move)
+    {
+        hexMap.applyCycle(triangles->getCycle(move));
+        truncate();
+        push(Entry{move.triangle, move.turn == Turn::Clockwise ? EntryKind::Clockwise : EntryKind::CounterClockwise});
+        if (needsKeyframe())
+        {
+            addKeyframe(hexMap.getColors());
+        }
+    }
+
+    /**
+     * Records the waves of the cascade's last run, which already changed the board, as one
+     * diff. Cells changed by several waves are stored once. Runs without waves record
+     * nothing.
+     */
+    template <typename Layout>
+    void recordCascade(const BasicHexMap<Layout> &hexMap, const Cascade &cascade)
+    {
+        if (cascade.getWaveCount() == 0)
+        {
+            return;
+        }
+        recordWaves(cascade);
+        if (needsKeyframe())
+        {
+            addKeyframe(hexMap.getColors());
+        }
+    }
+
+    template <typename Layout>
+    bool undo(BasicHexMap<Layout> &hexMap)
+    {
+        if (!canUndo())
+        {
+            return false;
+        }
+        position--;
+        replay(hexMap, position, false);
+        return true;
+    }
+
+    template <typename Layout>
+    bool redo(BasicHexMap<Layout> &hexMap)
+    {
+        if (!canRedo())
+        {
+            return false;
+        }
+        replay(hexMap, position, true);
+        position++;
+        return true;
+    }
+
+    /**
+     * Brings the board to the state after the first target entries, stepping from the
+     * current position or from the nearest keyframe, whichever takes fewer steps.
+     * Throws when target is past the recorded entries.
+     */
+    template <typename Layout>
+    void jumpTo(BasicHexMap<Layout> &hexMap, size_t target)
+    {
+        if (target > entries.size())
+        {
+            throw std::out_of_range("Journal: position past the recorded entries");
+        }
+        const Keyframe &keyframe = keyframeBefore(target);
+        const size_t stepsFromHere = target > position ? target - position : position - target;
+        if (target - keyframe.position < stepsFromHere)
+        {
+            scratch.resize(keyframe.colors.size());
+            keyframe.colors.unpack(scratch);
+            hexMap.assignColors(scratch);
+            position = keyframe.position;
+        }
+        while (position < target)
+        {
+            redo(hexMap);
+        }
+        while (position > target)
+        {
+            undo(hexMap);
+        }
+    }
+};
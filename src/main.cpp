@@ -1,155 +1,33 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "cursor.hpp"
+#include "generate.hpp"
+#include "hex_map.hpp"
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cmath>
+#include <cstdint>
 #include <optional>
-#include <unordered_map>
 #include <array>
 #include <print>
 #include <iostream>
 
 const int SCREEN_WIDTH{800};
 const int SCREEN_HEIGHT{600};
-const int HEX_SIZE{16};
+const int BOARD_RADIUS{10};
 const float HEX_RADIUS{std::sqrt(3.0f) * HEX_SIZE};
 
-class Hex
-{
-public:
-    int q;
-    int r;
-    int s;
-
-    constexpr Hex(int q_in, int r_in, int s_in)
-        : q(q_in), r(r_in), s(s_in)
-    {
-        // Ensure the constraint is checked at compile time if possible
-        assert(q + r + s == 0 && "Invalid Hex: q + r + s must equal 0");
-    }
-
-    bool operator==(const Hex &other) const
-    {
-        return q == other.q && r == other.r;
-    }
-
-    Vector2 toPixel() const
-    {
-        return {
-            HEX_SIZE * ((std::sqrt(3.0f) * static_cast<float>(q)) + ((std::sqrt(3.0f) / 2) * static_cast<float>(r))),
-            HEX_SIZE * ((3.0f / 2) * static_cast<float>(r))};
-    }
-};
-
-constexpr Hex hexAdd(const Hex &a, const Hex &b)
-{
-    return {a.q + b.q, a.r + b.r, a.s + b.s};
-}
-
-constexpr Hex hexSubtract(const Hex &a, const Hex &b)
-{
-    return {a.q - b.q, a.r - b.r, a.s - b.s};
-}
-
-constexpr Hex hexMultiply(const Hex &a, int scalar)
-{
-    return {a.q * scalar, a.r * scalar, a.s * scalar};
-}
-
-constexpr int hexLength(const Hex &hex)
-{
-    return int((abs(hex.q) + abs(hex.r) + abs(hex.s)) / 2);
-}
-
-constexpr int hexDistance(const Hex &a, const Hex &b)
-{
-    return hexLength(hexSubtract(a, b));
-}
-
-enum class HexDirection
-{
-    East,      // right  (1, 0, -1)
-    SouthEast, // up-right (1, -1, 0)
-    SouthWest, // up-left (0, -1, 1)
-    West,      // left (-1, 0, 1)
-    NorthWest, // down-left (-1, 1, 0)
-    NorthEast  // down-right (0, 1, -1)
-};
-
-constexpr std::array<Hex, 6> hex_directions = {
-    Hex(1, 0, -1), Hex(1, -1, 0), Hex(0, -1, 1),
-    Hex(-1, 0, 1), Hex(-1, 1, 0), Hex(0, 1, -1)};
-
-constexpr const Hex &hexDirection(HexDirection direction)
-{
-    return hex_directions[(size_t)direction];
-}
-
-constexpr Hex hexNeighbour(const Hex &hex, HexDirection direction)
-{
-    return hexAdd(hex, hexDirection(direction));
-}
-
-// This code is implementing a hash function for a custom Hex class to allow it to be used in hash-based containers like std::unordered_map or std::unordered_set.
-namespace std
-{
-    template <>
-    struct hash<Hex>
-    {
-        size_t operator()(const Hex &h) const
-        {
-            hash<int> int_hash;
-            size_t hq = int_hash(h.q);
-            size_t hr = int_hash(h.r);
-            // magic constant from golden ratio for better distribution.
-            return hq ^ (hr + 0x9e3779b9 + (hq << 6) + (hq >> 2));
-        }
-    };
-}
-
-const std::array<Color, 3> availableColors{
+// The colour of each palette index.
+const std::array<Color, PALETTE_SIZE> availableColors{
     ORANGE,
     MAROON,
     LIME};
 
-class Cell
+Vector2 toVector2(const Point &point)
 {
-public:
-    std::optional<Hex> rotatingTo;
-    float rotationProgress;
-    Color color;
-    Cell() : color(availableColors[static_cast<size_t>(GetRandomValue(0, availableColors.size() - 1))]) {}
-
-    void startRotation(const Hex &hex)
-    {
-        rotatingTo = hex;
-        rotationProgress = 0.0f;
-    }
-
-    void stepRotation(float dt)
-    {
-        if (rotatingTo)
-        {
-            float newRotation = rotationProgress + dt * 4.0f;
-            if (newRotation > 1.0f)
-            {
-                newRotation = 1.0f;
-            }
-            rotationProgress = newRotation;
-        }
-    }
-
-    bool rotationDone() const
-    {
-        return !rotatingTo.has_value() || rotationProgress >= 1.0f;
-    }
-
-    void resetRotation()
-    {
-        rotationProgress = -1.0f;
-        rotatingTo.reset();
-    }
-};
+    return {point.x, point.y};
+}
 
 /**
  * Rotates a point around a pivot by a certain progress towards a 120-degree clockwise rotation.
@@ -188,190 +66,45 @@ Vector2 rotatePoint(const Vector2 &start, const Vector2 &end, const Vector2 &piv
         pivot.y + sinf(currentAngle) * radius};
 }
 
-Vector2 hexesPixelPivot(const std::array<Hex, 3> &hexes)
-{
-    Vector2 sum = {0, 0};
-    for (const Hex &hex : hexes)
-    {
-        sum = Vector2Add(sum, hex.toPixel());
-    }
-    return Vector2Scale(sum, 1.0f / 3.0f);
-}
-
-class HexMap
-{
-    std::unordered_map<Hex, Cell> cells;
-    std::optional<std::array<Hex, 3>> rotation;
-
-public:
-    using iterator = typename std::unordered_map<Hex, Cell>::iterator;
-    using const_iterator = typename std::unordered_map<Hex, Cell>::const_iterator;
-
-    iterator begin() { return cells.begin(); }
-    iterator end() { return cells.end(); }
-
-    const_iterator begin() const { return cells.begin(); }
-    const_iterator end() const { return cells.end(); }
-
-    const auto &getRotation() const { return rotation; }
-    bool hasRotation() const { return rotation.has_value(); }
-
-    void insert(const Hex &hex, const Cell &cell)
-    {
-        cells.emplace(hex, cell);
-    }
-
-    void startRotation(const std::array<Hex, 3> &hexes)
-    {
-        rotation = hexes;
-        auto &rot = *rotation;
-
-        Cell &cell0 = cells.at(rot[0]);
-        Cell &cell1 = cells.at(rot[1]);
-        Cell &cell2 = cells.at(rot[2]);
-
-        cell1.startRotation(rot[0]);
-        cell2.startRotation(rot[1]);
-        cell0.startRotation(rot[2]);
-    }
-
-    void stepRotation(float dt)
-    {
-        if (rotation)
-        {
-            auto &rot = *rotation;
-            Cell &cell0 = cells.at(rot[0]);
-            Cell &cell1 = cells.at(rot[1]);
-            Cell &cell2 = cells.at(rot[2]);
-
-            cell0.stepRotation(dt);
-            cell1.stepRotation(dt);
-            cell2.stepRotation(dt);
-
-            if (cell0.rotationDone() && cell1.rotationDone() && cell2.rotationDone())
-            {
-                std::swap(cell0, cells[*cell0.rotatingTo]);
-                std::swap(cell1, cells[*cell1.rotatingTo]);
-                std::swap(cell2, cells[*cell2.rotatingTo]);
-
-                cell0.resetRotation();
-                cell1.resetRotation();
-                cell2.resetRotation();
-
-                rotation.reset();
-            }
-        }
-    }
-
-    const Cell &at(const Hex &h) const
-    {
-        return cells.at(h);
-    }
-};
-
-class Cursor
+void drawCell(Vector2 pos, PaletteIndex color)
 {
-    std::array<Hex, 3> hexes;
+    pos.x += SCREEN_WIDTH / 2.f;
+    pos.y += SCREEN_HEIGHT / 2.f;
 
-public:
-    Cursor(Hex topHex) : hexes{
-                             topHex,
-                             hexNeighbour(topHex, HexDirection::NorthWest),
-                             hexNeighbour(topHex, HexDirection::NorthEast)} {}
-
-    const auto &getHexes() const { return hexes; }
-
-    void moveUp()
-    {
-        if (hexes[0].r % 2 == 0)
-        {
-            move(HexDirection::SouthEast);
-        }
-        else
-        {
-            move(HexDirection::SouthWest);
-        }
-    }
-
-    void moveDown()
-    {
-        if (hexes[0].r % 2 == 0)
-        {
-            move(HexDirection::NorthEast);
-        }
-        else
-        {
-            move(HexDirection::NorthWest);
-        }
-    }
-
-    void moveLeft()
-    {
-        move(HexDirection::West);
-    }
-
-    void moveRight()
-    {
-        move(HexDirection::East);
-    }
-
-    void move(HexDirection hexDir)
-    {
-        hexes[0] = hexNeighbour(hexes[0], hexDir);
-        hexes[1] = hexNeighbour(hexes[1], hexDir);
-        hexes[2] = hexNeighbour(hexes[2], hexDir);
-    }
-};
-
-HexMap generateHexMap(int size)
-{
-    HexMap hexMap = HexMap();
-    for (int q = -size; q <= size; q++)
-    {
-        int r1 = std::max(-size, -q - size);
-        int r2 = std::min(size, -q + size);
-        for (int r = r1; r <= r2; r++)
-        {
-            hexMap.insert(Hex(q, r, -q - r), Cell());
-        }
-    }
-    return hexMap;
+    DrawPoly(pos, 6, HEX_SIZE, 30, availableColors[color]);
+    DrawPolyLinesEx(pos, 6, HEX_SIZE, 30, 1, WHITE);
 }
 
-void drawGrid(HexMap &hexMap, const Cursor &cursor)
+template <typename Layout>
+void drawGrid(const BasicHexMap<Layout> &hexMap, const TriangleTable &triangles, const Cursor &cursor)
 {
     BeginDrawing();
     ClearBackground(RAYWHITE);
     const auto &rotation = hexMap.getRotation();
+    const auto colors = hexMap.getColors();
+    const auto pixels = hexMap.getPixels();
 
-    for (auto &pair : hexMap)
+    for (size_t i = 0; i < colors.size(); i++)
     {
-        const Hex &hex = pair.first;
-        const Cell &cell = pair.second;
-
-        Vector2 pos;
-        if (cell.rotatingTo.has_value() && rotation)
+        if (!hexMap.isAnimating(i))
         {
-
-            const Vector2 startPos = hex.toPixel();
-            const Vector2 endPos = cell.rotatingTo->toPixel();
-            pos = rotatePoint(startPos, endPos, hexesPixelPivot(*rotation), cell.rotationProgress);
+            drawCell(toVector2(pixels[i]), colors[i]);
         }
-        else
+    }
+
+    if (rotation)
+    {
+        const Vector2 pivot = toVector2(triangles.getPivot(*triangles.find(hexMap.getLayout(), (*rotation)[0])));
+        for (const CellAnimation &animation : hexMap.getAnimations())
         {
-            pos = hex.toPixel();
+            drawCell(rotatePoint(toVector2(pixels[animation.from]), toVector2(pixels[animation.to]), pivot, animation.progress),
+                     colors[animation.from]);
         }
-
-        pos.x += SCREEN_WIDTH / 2.f;
-        pos.y += SCREEN_HEIGHT / 2.f;
-
-        DrawPoly(pos, 6, HEX_SIZE, 30, cell.color);
-        DrawPolyLinesEx(pos, 6, HEX_SIZE, 30, 1, WHITE);
     }
 
     for (const auto &hex : cursor.getHexes())
     {
-        Vector2 pos = hex.toPixel();
+        Vector2 pos = toVector2(hex.toPixel());
         pos.x += SCREEN_WIDTH / 2.f;
         pos.y += SCREEN_HEIGHT / 2.f;
 
@@ -380,7 +113,7 @@ void drawGrid(HexMap &hexMap, const Cursor &cursor)
 
     /*
     // DEBUG CODE FOR VISUALIZING ROTAION OF HEXES
-    Vector2 circlePivot = hexesPixelPivot(cursor.getHexes());
+    Vector2 circlePivot = toVector2(cursor.getPivot());
     circlePivot.x += SCREEN_WIDTH / 2.f;
     circlePivot.y += SCREEN_HEIGHT / 2.f;
 
@@ -389,14 +122,14 @@ void drawGrid(HexMap &hexMap, const Cursor &cursor)
     auto hex1 = hexes[0];
     auto hex2 = hexes[1];
     auto hex3 = hexes[2];
-    auto hexPos1 = rotatePoint(hex1.toPixel(), hex2.toPixel(), hexesPixelPivot(cursor.getHexes()), 0);
-    // auto hexPos1 = hex2.toPixel();
+    auto hexPos1 = rotatePoint(toVector2(hex1.toPixel()), toVector2(hex2.toPixel()), toVector2(cursor.getPivot()), 0);
+    // auto hexPos1 = toVector2(hex2.toPixel());
     hexPos1.x += (SCREEN_WIDTH / 2.f);
     hexPos1.y += (SCREEN_HEIGHT / 2.f);
-    auto hexPos2 = rotatePoint(hex1.toPixel(), hex2.toPixel(), hexesPixelPivot(cursor.getHexes()), 0.5);
+    auto hexPos2 = rotatePoint(toVector2(hex1.toPixel()), toVector2(hex2.toPixel()), toVector2(cursor.getPivot()), 0.5);
     hexPos2.x += (SCREEN_WIDTH / 2.f);
     hexPos2.y += (SCREEN_HEIGHT / 2.f);
-    auto hexPos3 = rotatePoint(hex1.toPixel(), hex2.toPixel(), hexesPixelPivot(cursor.getHexes()), 1);
+    auto hexPos3 = rotatePoint(toVector2(hex1.toPixel()), toVector2(hex2.toPixel()), toVector2(cursor.getPivot()), 1);
     hexPos3.x += (SCREEN_WIDTH / 2.f);
     hexPos3.y += (SCREEN_HEIGHT / 2.f);
 
@@ -416,8 +149,10 @@ int main()
     // Setting the Frames Per Second
     SetTargetFPS(60);
 
-    HexMap hexMap = generateHexMap(10);
-    Cursor cursor = Cursor(Hex(2, 2, -4));
+    // raylib seeds its generator from the clock, so every game gets a new board.
+    auto hexMap = generateHexMapFixed<BOARD_RADIUS>(static_cast<std::uint64_t>(GetRandomValue(0, INT_MAX)));
+    const TriangleTable triangles(hexMap.getLayout());
+    Cursor cursor = Cursor(triangles, *triangles.find(hexMap.getLayout(), Hex(2, 2, -4)));
 
     // The Game Loop
     while (!WindowShouldClose() /*WindowShouldClose returns true if esc is clicked and closes the window*/)
@@ -447,7 +182,7 @@ int main()
 
         hexMap.stepRotation(dt);
 
-        drawGrid(hexMap, cursor);
+        drawGrid(hexMap, triangles, cursor);
     }
     CloseWindow();
     return 0;
@@ -0,0 +1,99 @@
+#include "match.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void MatchFinder::nextEpoch()
+{
+    if (++epoch == 0)
+    {
+        std::ranges::fill(visited, 0);
+        epoch = 1;
+    }
+}
+
+void MatchFinder::fill(std::span<const PaletteIndex> paddedColors, std::uint32_t seed)
+{
+    const PaletteIndex color = paddedColors[seed];
+    if (visited[seed] == epoch || color == GHOST_COLOR)
+    {
+        return;
+    }
+
+    // The cells list doubles as the flood fill's queue: everything from begin on is the
+    // cluster found so far, and the cells after i still need their neighbours checked.
+    const size_t begin = cells.size();
+    visited[seed] = epoch;
+    cells.push_back(seed);
+    for (size_t i = begin; i < cells.size(); i++)
+    {
+        for (std::uint32_t next : neighbours[cells[i]])
+        {
+            if (visited[next] != epoch && paddedColors[next] == color)
+            {
+                visited[next] = epoch;
+                cells.push_back(next);
+            }
+        }
+    }
+
+    // Too small clusters stay visited, so another seed in them is skipped right away.
+    if (cells.size() - begin < minClusterSize)
+    {
+        cells.resize(begin);
+        return;
+    }
+    clusterEnds.push_back(static_cast<std::uint32_t>(cells.size()));
+}
+
+std::span<const std::uint32_t> MatchFinder::find(std::span<const PaletteIndex> paddedColors,
+                                                 std::span<const std::uint32_t> seeds)
+{
+    if (paddedColors.size() != visited.size())
+    {
+        throw std::invalid_argument("MatchFinder: colours do not match the layout");
+    }
+    cells.clear();
+    clusterEnds.clear();
+    nextEpoch();
+    for (std::uint32_t seed : seeds)
+    {
+        fill(paddedColors, seed);
+    }
+    return cells;
+}
+
+bool MatchFinder::hasMatch(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> seeds)
+{
+    if (paddedColors.size() != visited.size())
+    {
+        throw std::invalid_argument("MatchFinder: colours do not match the layout");
+    }
+    auto colorOf = [paddedColors](std::uint32_t cell)
+    {
+        return paddedColors[cell];
+    };
+    for (std::uint32_t seed : seeds)
+    {
+        if (paddedColors[seed] != GHOST_COLOR && clusterSize(seed, colorOf, minClusterSize) >= minClusterSize)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::span<const std::uint32_t> MatchFinder::findAll(std::span<const PaletteIndex> paddedColors)
+{
+    if (paddedColors.size() != visited.size())
+    {
+        throw std::invalid_argument("MatchFinder: colours do not match the layout");
+    }
+    cells.clear();
+    clusterEnds.clear();
+    nextEpoch();
+    for (size_t cell = 0; cell + 1 < paddedColors.size(); cell++)
+    {
+        fill(paddedColors, static_cast<std::uint32_t>(cell));
+    }
+    return cells;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "hex_map.hpp"
+#include "palette.hpp"
+#include "rotation.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+const size_t MIN_CLUSTER_SIZE{3};
+
+/**
+ * Finds connected groups of same coloured cells of at least a minimum size. After a
+ * rotation only the clusters through the three turned cells can have changed, so find()
+ * flood fills from those cells over a NeighbourTable and never looks at the rest of the
+ * board. It collects every cluster whole, to clear it, so it costs as much as the
+ * clusters it visits: on a board with one huge same coloured region, as much as a scan.
+ * hasMatch() only answers whether there is a match and stops each fill once it reaches
+ * the minimum size, so it costs O(minClusterSize) per seed on any board.
+ *
+ * Results are one compact list of cell slots, grouped by cluster. The list and the
+ * visited marks are reused between calls, and the marks are cleared by bumping an epoch
+ * rather than by a pass over the board, so a call allocates nothing once warmed up.
+ */
+class MatchFinder
+{
+    NeighbourTable neighbours;
+    size_t minClusterSize;
+    // Per slot, the epoch it was last visited in. Any older epoch means not visited yet.
+    std::vector<std::uint32_t> visited;
+    std::uint32_t epoch = 0;
+    // Matched cells, cluster after cluster; clusterEnds holds where each one stops.
+    std::vector<std::uint32_t> cells;
+    std::vector<std::uint32_t> clusterEnds;
+    // The flood fill queue of clusterSize() and hasMatch(), apart from the results.
+    std::vector<std::uint32_t> probe;
+
+    void nextEpoch();
+    void fill(std::span<const PaletteIndex> paddedColors, std::uint32_t seed);
+
+public:
+    template <typename Layout>
+    explicit MatchFinder(const Layout &layout, size_t minClusterSize_in = MIN_CLUSTER_SIZE)
+        : neighbours(layout), minClusterSize(minClusterSize_in), visited(layout.size() + 1, 0)
+    {
+    }
+
+    size_t getMinClusterSize() const { return minClusterSize; }
+    const NeighbourTable &getNeighbours() const { return neighbours; }
+
+    /**
+     * Finds the clusters through the seed cells. paddedColors holds the board's colours
+     * followed by the ghost slot, as BasicHexMap::getPaddedColors() returns them. Returns
+     * the matched cells, valid until the next call. Throws when the colours do not
+     * match the layout the finder was built for.
+     */
+    std::span<const std::uint32_t> find(std::span<const PaletteIndex> paddedColors,
+                                        std::span<const std::uint32_t> seeds);
+
+    // The clusters through the cells of a rotation that was just applied.
+    template <typename Layout>
+    std::span<const std::uint32_t> find(const BasicHexMap<Layout> &hexMap, const IndexCycle &cycle)
+    {
+        return find(hexMap.getPaddedColors(), cycle.cells);
+    }
+
+    /**
+     * Whether a cluster runs through any of the seed cells, without collecting it. Leaves
+     * the results of the last find() alone. Throws as find() does.
+     */
+    bool hasMatch(std::span<const PaletteIndex> paddedColors, std::span<const std::uint32_t> seeds);
+
+    // Whether the rotation that was just applied made a match.
+    template <typename Layout>
+    bool hasMatch(const BasicHexMap<Layout> &hexMap, const IndexCycle &cycle)
+    {
+        return hasMatch(hexMap.getPaddedColors(), cycle.cells);
+    }
+
+    // Every cluster on the board, for a freshly generated board or to verify find().
+    std::span<const std::uint32_t> findAll(std::span<const PaletteIndex> paddedColors);
+
+    /**
+     * The size of the cluster a cell is part of, counted up to limit, on a board whose
+     * colours colorOf(slot) returns. Lets callers try out colours without writing them.
+     * Leaves the results of the last find() alone.
+     */
+    template <typename ColorOf>
+    size_t clusterSize(std::uint32_t cell, ColorOf &&colorOf, size_t limit)
+    {
+        nextEpoch();
+        const PaletteIndex color = colorOf(cell);
+        probe.clear();
+        probe.push_back(cell);
+        visited[cell] = epoch;
+        for (size_t i = 0; i < probe.size() && probe.size() < limit; i++)
+        {
+            for (std::uint32_t next : neighbours[probe[i]])
+            {
+                if (visited[next] != epoch && colorOf(next) == color)
+                {
+                    visited[next] = epoch;
+                    probe.push_back(next);
+                }
+            }
+        }
+        return std::min(probe.size(), limit);
+    }
+
+    std::span<const std::uint32_t> getCells() const { return cells; }
+    size_t getClusterCount() const { return clusterEnds.size(); }
+
+    // The cells of one cluster of the last call.
+    std::span<const std::uint32_t> getCluster(size_t cluster) const
+    {
+        const size_t begin = cluster == 0 ? 0 : clusterEnds[cluster - 1];
+        return std::span(cells).subspan(begin, clusterEnds[cluster] - begin);
+    }
+};
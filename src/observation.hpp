@@ -0,0 +1,167 @@
+#pragma once
+
+#include "board_batch.hpp"
+#include "hex.hpp"
+#include "hex_map.hpp"
+#include "palette.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * A strided view of palette indices owned by someone else, in the spirit of DLPack: the
+ * consumer reads element (i, j) at data[i * strides[0] + j * strides[1]]. Unused
+ * dimensions have extent 1.
+ */
+struct ColorTensorView
+{
+    const PaletteIndex *data = nullptr;
+    size_t dimensions = 0;
+    std::array<size_t, 2> shape{1, 1};
+    std::array<size_t, 2> strides{0, 0};
+};
+
+// The colour column of a board as a [cells] tensor, aliasing the map's storage.
+template <typename Layout>
+ColorTensorView viewColors(const BasicHexMap<Layout> &hexMap)
+{
+    return ColorTensorView{hexMap.getColors().data(), 1, {hexMap.size(), 1}, {1, 0}};
+}
+
+// The colour block of a batch as a [cells, boards] tensor, aliasing the batch's storage.
+inline ColorTensorView viewColors(const BoardBatch &batch)
+{
+    return ColorTensorView{batch.getColors().data(), 2, {batch.getCellCount(), batch.size()}, {batch.size(), 1}};
+}
+
+/**
+ * Writes boards as observation tensors for learning agents: PALETTE_SIZE one-hot colour
+ * planes followed by a mask plane, each H x W over the axial rectangle that bounds the
+ * board, row r - minR and column q - minQ. Off-board positions are 0 in every plane,
+ * on-board ones 1 in the mask plane. The plane position of every slot is worked out once,
+ * so encoding is a clear of the buffer and two scattered stores per cell.
+ *
+ * Agents that embed colours themselves can skip the one-hot copy entirely: viewColors()
+ * aliases the board's own colour storage and getCellPositions() says where each slot
+ * sits in the planes.
+ */
+class ObservationEncoder
+{
+    size_t height = 0;
+    size_t width = 0;
+    // Per slot, its position in a plane: row * width + column.
+    std::vector<std::uint32_t> cellPositions;
+
+    void checkSize(size_t cellCount, size_t boardCount, size_t outSize) const
+    {
+        if (cellCount != cellPositions.size())
+        {
+            throw std::invalid_argument("ObservationEncoder: board does not match the encoder's layout");
+        }
+        if (outSize != boardCount * getObservationSize())
+        {
+            throw std::invalid_argument("ObservationEncoder: output buffer has the wrong size");
+        }
+    }
+
+public:
+    static constexpr size_t PLANE_COUNT = PALETTE_SIZE + 1;
+
+    template <typename Layout>
+    explicit ObservationEncoder(const Layout &layout)
+    {
+        const auto hexes = layout.getHexes();
+        if (hexes.empty())
+        {
+            return;
+        }
+        int minQ = std::numeric_limits<int>::max();
+        int maxQ = std::numeric_limits<int>::min();
+        int minR = std::numeric_limits<int>::max();
+        int maxR = std::numeric_limits<int>::min();
+        for (const Hex &hex : hexes)
+        {
+            minQ = std::min(minQ, hex.q);
+            maxQ = std::max(maxQ, hex.q);
+            minR = std::min(minR, hex.r);
+            maxR = std::max(maxR, hex.r);
+        }
+        height = static_cast<size_t>(maxR - minR + 1);
+        width = static_cast<size_t>(maxQ - minQ + 1);
+
+        cellPositions.reserve(hexes.size());
+        for (const Hex &hex : hexes)
+        {
+            cellPositions.push_back(static_cast<std::uint32_t>(static_cast<size_t>(hex.r - minR) * width +
+                                                               static_cast<size_t>(hex.q - minQ)));
+        }
+    }
+
+    size_t getHeight() const { return height; }
+    size_t getWidth() const { return width; }
+    size_t getPlaneSize() const { return height * width; }
+    // Elements of one board's observation, PLANE_COUNT x H x W.
+    size_t getObservationSize() const { return PLANE_COUNT * getPlaneSize(); }
+    std::span<const std::uint32_t> getCellPositions() const { return cellPositions; }
+
+    /**
+     * Writes one board, given as its colour column, to out, which holds
+     * getObservationSize() elements. Colours outside the palette set no colour plane.
+     */
+    template <typename T>
+    void encode(std::span<const PaletteIndex> colors, std::span<T> out) const
+    {
+        checkSize(colors.size(), 1, out.size());
+        const size_t planeSize = getPlaneSize();
+        std::fill(out.begin(), out.end(), T(0));
+        T *mask = out.data() + PALETTE_SIZE * planeSize;
+        for (size_t i = 0; i < cellPositions.size(); i++)
+        {
+            const size_t position = cellPositions[i];
+            mask[position] = T(1);
+            if (colors[i] < PALETTE_SIZE)
+            {
+                out[colors[i] * planeSize + position] = T(1);
+            }
+        }
+    }
+
+    template <typename T, typename Layout>
+    void encode(const BasicHexMap<Layout> &hexMap, std::span<T> out) const
+    {
+        encode(hexMap.getColors(), out);
+    }
+
+    // Writes every board of the batch, board after board, to out, which holds
+    // batch.size() * getObservationSize() elements.
+    template <typename T>
+    void encode(const BoardBatch &batch, std::span<T> out) const
+    {
+        const size_t boardCount = batch.size();
+        const size_t cellCount = batch.getCellCount();
+        checkSize(cellCount, boardCount, out.size());
+        const size_t observationSize = getObservationSize();
+
+        // The batch stores cells major, so a board's colours are a row apart. Transpose a
+        // few boards at a time into contiguous colour columns with BoardBatch::observe(),
+        // which works on 8x8 tiles, then encode those board by board while they and the
+        // boards' planes are in cache.
+        const size_t tileBoards = std::min<size_t>(boardCount, 8);
+        std::vector<PaletteIndex> boardColors(tileBoards * cellCount);
+        for (size_t firstBoard = 0; firstBoard < boardCount; firstBoard += tileBoards)
+        {
+            const size_t count = std::min(tileBoards, boardCount - firstBoard);
+            batch.observe(firstBoard, count, boardColors);
+            for (size_t board = 0; board < count; board++)
+            {
+                encode(std::span<const PaletteIndex>(boardColors).subspan(board * cellCount, cellCount),
+                       out.subspan((firstBoard + board) * observationSize, observationSize));
+            }
+        }
+    }
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "hex.hpp"
+#include "palette.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Read-only palette indices packed Bits to a cell into 64-bit words owned by someone
+ * else, cell i in bits [(i % PER_WORD) * Bits, ...) of word i / PER_WORD. Two bits cover
+ * the three colour palette the game uses, four bits palettes of up to sixteen colours.
+ */
+template <int Bits>
+class PackedColorsView
+{
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8, "Bits must divide 64 and fit a PaletteIndex");
+
+public:
+    static constexpr size_t PER_WORD = 64 / Bits;
+    static constexpr std::uint64_t MASK = (std::uint64_t{1} << Bits) - 1;
+
+    // Words needed for count cells.
+    static constexpr size_t wordCount(size_t count) { return (count + PER_WORD - 1) / PER_WORD; }
+
+private:
+    std::span<const std::uint64_t> words;
+    size_t count = 0;
+
+public:
+    PackedColorsView() = default;
+    // words must hold at least wordCount(count) words.
+    PackedColorsView(std::span<const std::uint64_t> words_in, size_t count_in) : words(words_in), count(count_in) {}
+
+    size_t size() const { return count; }
+    std::span<const std::uint64_t> getWords() const { return words; }
+
+    PaletteIndex get(size_t index) const
+    {
+        return static_cast<PaletteIndex>((words[index / PER_WORD] >> ((index % PER_WORD) * Bits)) & MASK);
+    }
+
+    // Calls f(index, color) for every cell, decoding a word at a time.
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        for (size_t w = 0; w < wordCount(count); w++)
+        {
+            const size_t first = w * PER_WORD;
+            const size_t last = std::min(first + PER_WORD, count);
+            std::uint64_t word = words[w];
+            for (size_t i = first; i < last; i++, word >>= Bits)
+            {
+                f(i, static_cast<PaletteIndex>(word & MASK));
+            }
+        }
+    }
+
+    // Unpacks every colour into out, which must hold size() entries.
+    void unpack(std::span<PaletteIndex> out) const
+    {
+        forEach([out](size_t index, PaletteIndex color)
+                { out[index] = color; });
+    }
+};
+
+// PackedColorsView's layout in words of its own.
+template <int Bits>
+class PackedColors
+{
+public:
+    using View = PackedColorsView<Bits>;
+    static constexpr size_t PER_WORD = View::PER_WORD;
+    static constexpr std::uint64_t MASK = View::MASK;
+
+private:
+    std::vector<std::uint64_t> words;
+    size_t count = 0;
+
+public:
+    PackedColors() = default;
+    explicit PackedColors(size_t count_in) : words(View::wordCount(count_in), 0), count(count_in) {}
+
+    size_t size() const { return count; }
+    std::span<const std::uint64_t> getWords() const { return words; }
+    size_t memoryUsage() const { return words.size() * sizeof(std::uint64_t); }
+    View view() const { return View(words, count); }
+
+    PaletteIndex get(size_t index) const { return view().get(index); }
+
+    void set(size_t index, PaletteIndex color)
+    {
+        std::uint64_t &word = words[index / PER_WORD];
+        const size_t shift = (index % PER_WORD) * Bits;
+        word = (word & ~(MASK << shift)) | ((static_cast<std::uint64_t>(color) & MASK) << shift);
+    }
+
+    // Packs a whole column of unpacked colours, one word at a time.
+    void assign(std::span<const PaletteIndex> colors)
+    {
+        count = colors.size();
+        words.assign(View::wordCount(count), 0);
+        for (size_t w = 0; w < words.size(); w++)
+        {
+            const size_t first = w * PER_WORD;
+            const size_t last = std::min(first + PER_WORD, count);
+            std::uint64_t word = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                word |= (static_cast<std::uint64_t>(colors[i]) & MASK) << ((i - first) * Bits);
+            }
+            words[w] = word;
+        }
+    }
+
+    // Calls f(index, color) for every cell, decoding a word at a time.
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        view().forEach(f);
+    }
+
+    // Unpacks every colour into out, which must hold size() entries.
+    void unpack(std::span<PaletteIndex> out) const { view().unpack(out); }
+};
+
+/**
+ * Hexagon board that stores nothing but bit-packed palette indices, for boards too large
+ * for BasicHexMap's per-cell columns. Cells are in the same row by row order as
+ * HexagonLayout, so a HexMap's colour column packs straight into it with assign().
+ * At two bits a cell a 10M cell board takes about 2.5 MB.
+ */
+template <int Bits = 2>
+class PackedHexMap
+{
+    int radius;
+    // Per row (r + radius): the index of the row's first cell minus its first q.
+    std::vector<int> rowOffsets;
+    PackedColors<Bits> colors;
+
+public:
+    explicit PackedHexMap(int radius_in)
+        : radius(radius_in), rowOffsets(static_cast<size_t>(2 * radius_in + 1)),
+          colors(static_cast<size_t>(hexagonCellCount(radius_in)))
+    {
+        hexagonRowOffsets(radius, rowOffsets);
+    }
+
+    int getRadius() const { return radius; }
+    size_t size() const { return colors.size(); }
+    size_t memoryUsage() const { return colors.memoryUsage() + rowOffsets.size() * sizeof(int); }
+
+    const PackedColors<Bits> &getColors() const { return colors; }
+    PackedColors<Bits> &getColors() { return colors; }
+
+    bool contains(const Hex &hex) const
+    {
+        return hexLength(hex) <= radius;
+    }
+
+    // Unchecked, the hex must be on the board.
+    size_t index(const Hex &hex) const
+    {
+        return static_cast<size_t>(rowOffsets[static_cast<size_t>(hex.r + radius)] + hex.q);
+    }
+
+    std::optional<size_t> find(const Hex &hex) const
+    {
+        if (!contains(hex))
+        {
+            return std::nullopt;
+        }
+        return index(hex);
+    }
+
+    PaletteIndex at(const Hex &hex) const
+    {
+        auto found = find(hex);
+        if (!found)
+        {
+            throw std::out_of_range("PackedHexMap: hex is outside of the board");
+        }
+        return colors.get(*found);
+    }
+
+    void insert(const Hex &hex, PaletteIndex color)
+    {
+        auto found = find(hex);
+        if (!found)
+        {
+            throw std::out_of_range("PackedHexMap: hex is outside of the board");
+        }
+        colors.set(*found, color);
+    }
+
+    // Calls f(hex, color) for every cell in storage order.
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        int r = -radius;
+        int q = hexagonRowFirstQ(radius, r);
+        colors.forEach([&](size_t, PaletteIndex color)
+                       {
+            f(Hex(q, r, -q - r), color);
+            if (++q > hexagonRowLastQ(radius, r))
+            {
+                r++;
+                q = hexagonRowFirstQ(radius, r);
+            } });
+    }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Cells store an index into a palette rather than a full colour.
+using PaletteIndex = std::uint8_t;
+
+// Number of colours cells are generated with. The front end maps each index to a colour.
+const size_t PALETTE_SIZE{3};
+
+// Colour of the ghost slot off-board neighbours resolve to. It never equals a real colour.
+const PaletteIndex GHOST_COLOR{0xFF};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// The number of threads to use when a caller asks for 0, meaning "all of them".
+inline unsigned resolveThreadCount(unsigned threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threadCount;
+}
+
+/**
+ * Calls f(i) for every i in [0, count) on up to threadCount threads, the calling thread
+ * included. Indices are handed out one at a time from a shared counter, so uneven items
+ * balance out. Which thread runs an item is unspecified, so f must not depend on it.
+ */
+template <typename F>
+void parallelFor(size_t count, unsigned threadCount, F &&f)
+{
+    threadCount = static_cast<unsigned>(std::min<size_t>(resolveThreadCount(threadCount), count));
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            f(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]
+    {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed))
+        {
+            f(i);
+        }
+    };
+
+    std::vector<std::jthread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+}
@@ -0,0 +1,149 @@
+#include "parallel_solver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <mutex>
+#include <stdexcept>
+
+namespace
+{
+// Subtrees with fewer levels left than this are never split, they finish too quickly
+// to be worth a task.
+const int MIN_SPLIT_REMAINING{3};
+
+void lowerTo(std::atomic<int> &value, int candidate)
+{
+    int current = value.load(std::memory_order_relaxed);
+    while (candidate < current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+    {
+    }
+}
+} // namespace
+
+ParallelSolver::ParallelSolver(const HexMap &start, unsigned threadCount, int tableBits)
+    : triangles(start.getLayout()), keys(start.getLayout()), symmetries(start.getLayout()), table(tableBits),
+      scheduler(threadCount)
+{
+    for (unsigned i = 0; i < scheduler.size(); i++)
+    {
+        searchers.push_back(std::make_unique<SolverSearch>(start, triangles, keys, table));
+    }
+}
+
+SolveResult ParallelSolver::run(const SolveGoal &goal, int maxDepth)
+{
+    if (maxDepth > UINT8_MAX)
+    {
+        throw std::invalid_argument("Solver: maxDepth must fit the transposition table");
+    }
+
+    std::atomic<bool> found{false};
+    std::mutex solutionMutex;
+    SolveResult result;
+    for (auto &searcher : searchers)
+    {
+        searcher->setGoal(goal);
+        searcher->setStop(&found);
+        searcher->resetNodes();
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    for (int bound = searchers[0]->heuristic(); bound <= maxDepth && !found;)
+    {
+        iteration = nextIteration(iteration, table);
+        std::atomic<int> nextBound{INT_MAX};
+
+        scheduler.push(0, {});
+        scheduler.run([&](unsigned worker, std::vector<TriangleMove> prefix)
+                      {
+            SolverSearch &searcher = *searchers[worker];
+            searcher.rewind();
+            for (const TriangleMove &move : prefix)
+            {
+                searcher.apply(move);
+            }
+
+            const int depth = static_cast<int>(prefix.size());
+            const int estimate = depth + searcher.heuristic();
+            if (estimate > bound)
+            {
+                lowerTo(nextBound, estimate);
+                return;
+            }
+
+            int outcome = SolverSearch::FOUND;
+            if (!searcher.isGoal())
+            {
+                if (!table.visit(searcher.tableKey(), iteration, static_cast<std::uint8_t>(depth)))
+                {
+                    return;
+                }
+                if (bound - depth >= MIN_SPLIT_REMAINING && (depth == 0 || scheduler.hasIdleWorkers()))
+                {
+                    const std::uint32_t lastTriangle = prefix.empty() ? TriangleTable::NO_TRIANGLE : prefix.back().triangle;
+                    for (std::uint32_t triangle = 0; triangle < triangles.size(); triangle++)
+                    {
+                        if (triangle == lastTriangle)
+                        {
+                            continue;
+                        }
+                        for (Turn turn : {Turn::Clockwise, Turn::CounterClockwise})
+                        {
+                            std::vector<TriangleMove> child = prefix;
+                            child.push_back(TriangleMove{triangle, turn});
+                            scheduler.push(worker, std::move(child));
+                        }
+                    }
+                    return;
+                }
+                outcome = searcher.searchChildren(depth, bound, iteration);
+            }
+
+            if (outcome == SolverSearch::FOUND)
+            {
+                std::lock_guard lock(solutionMutex);
+                if (!found.exchange(true))
+                {
+                    result.solved = true;
+                    result.moves = searcher.getPath();
+                }
+                scheduler.stop();
+                return;
+            }
+            lowerTo(nextBound, outcome); });
+
+        if (found || nextBound == INT_MAX)
+        {
+            break;
+        }
+        bound = nextBound;
+    }
+
+    for (auto &searcher : searchers)
+    {
+        searcher->rewind();
+        searcher->setStop(nullptr);
+        result.nodes += searcher->getNodes();
+        result.memoryUsage += solverSearchMemory(searcher->getBoard());
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.memoryUsage += table.memoryUsage() + keys.memoryUsage() + symmetries.memoryUsage() +
+                          triangles.size() * (sizeof(IndexCycle) + sizeof(Point) + 3 * sizeof(Hex) + 4 * sizeof(std::uint32_t));
+    return result;
+}
+
+SolveResult ParallelSolver::solve(std::span<const PaletteIndex> goal, int maxDepth)
+{
+    // Rotations only move colours around, a goal with other colour counts is unreachable.
+    if (!sameColorCounts(searchers[0]->getBoard().getColors(), goal))
+    {
+        return SolveResult{};
+    }
+    return run(SolveGoal{goal, nullptr}, maxDepth);
+}
+
+SolveResult ParallelSolver::solve(const GoalPredicate &goal, int maxDepth, bool symmetric)
+{
+    return run(SolveGoal{{}, &goal, symmetric ? &symmetries : nullptr}, maxDepth);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "solver.hpp"
+#include "work_stealing.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * Solver that runs each IDA* iteration on several threads. A task is a move prefix from
+ * the start board; a worker replays it on its own board and either searches the whole
+ * subtree below it or, while the subtree is deep and other workers are idle, splits it
+ * into one task per child for the WorkStealingScheduler to hand out. The first
+ * iteration always splits the root, so every worker starts out busy.
+ *
+ * All workers share one TranspositionTable, so a board one worker covered prunes the
+ * others too. Solutions are as short as the serial Solver's, though with several
+ * solutions of that length any one of them may come back.
+ */
+class ParallelSolver
+{
+    TriangleTable triangles;
+    ZobristTable keys;
+    BoardSymmetries symmetries;
+    TranspositionTable table;
+    WorkStealingScheduler<std::vector<TriangleMove>> scheduler;
+    std::vector<std::unique_ptr<SolverSearch>> searchers;
+    std::uint8_t iteration = 0;
+
+    SolveResult run(const SolveGoal &goal, int maxDepth);
+
+public:
+    // threadCount 0 uses every hardware thread.
+    ParallelSolver(const HexMap &start, unsigned threadCount, int tableBits = 22);
+
+    // The workers' searches point into the solver's own tables, so it stays where it was built.
+    ParallelSolver(const ParallelSolver &) = delete;
+    ParallelSolver &operator=(const ParallelSolver &) = delete;
+    ParallelSolver(ParallelSolver &&) = delete;
+    ParallelSolver &operator=(ParallelSolver &&) = delete;
+
+    unsigned getThreadCount() const { return scheduler.size(); }
+
+    // Searches for a board with exactly the goal colours, one per cell in slot order.
+    SolveResult solve(std::span<const PaletteIndex> goal, int maxDepth = 20);
+
+    // Searches for any board the predicate accepts, which must be safe to call from
+    // several threads at once. symmetric is as for Solver::solve().
+    SolveResult solve(const GoalPredicate &goal, int maxDepth = 20, bool symmetric = false);
+};
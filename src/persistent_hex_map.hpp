@@ -0,0 +1,210 @@
+#pragma once
+
+#include "hex.hpp"
+#include "hex_map.hpp"
+#include "palette.hpp"
+#include "rotation.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * A board whose copies are O(1) snapshots, for searches, hints and previews that fork
+ * the board, try moves and throw the fork away. The colour column is cut into pages of
+ * 2^PageBits cells in slot order, held by a two level page table: a root of directories
+ * of DIRECTORY_PAGES pages each. Copies share all of it. Writing copies whatever is
+ * shared along the path to the touched cell, the root, one directory and one page, so
+ * a fork costs a few hundred bytes plus the pages it actually changes, even on boards of
+ * millions of cells. A board nobody shares writes in place.
+ *
+ * The layout is shared by all boards of a family and the hash is kept up to date as in
+ * BasicHexMap, computing keys as cells change. Reading goes through the page table,
+ * and forEachPage() hands out whole pages as contiguous spans, so scans run over dense
+ * arrays whether pages are shared or not.
+ *
+ * Sharing is tracked with shared_ptr reference counts and pages are written in place
+ * once a board holds the only reference, so a board and its forks belong to one thread.
+ * To hand a board to another thread, build a fresh one from copyColors().
+ */
+template <typename Layout, int PageBits = 8>
+class BasicPersistentHexMap
+{
+    static_assert(Layout::FIXED_SHAPE, "the page table covers a fixed set of slots");
+
+public:
+    static constexpr size_t PAGE_CELLS = size_t{1} << PageBits;
+    static constexpr size_t DIRECTORY_PAGES = 64;
+
+private:
+    static constexpr size_t PAGE_MASK = PAGE_CELLS - 1;
+
+    using Page = std::array<PaletteIndex, PAGE_CELLS>;
+    using Directory = std::array<std::shared_ptr<Page>, DIRECTORY_PAGES>;
+    using Root = std::vector<std::shared_ptr<Directory>>;
+
+    std::shared_ptr<const Layout> layout;
+    std::shared_ptr<Root> root;
+    size_t pageCount = 0;
+    std::uint64_t hash = 0;
+
+    const Page &page(size_t index) const
+    {
+        return *(*(*root)[index / DIRECTORY_PAGES])[index % DIRECTORY_PAGES];
+    }
+
+    std::uint64_t keyOf(size_t slot, PaletteIndex color) const
+    {
+        return zobristKey(layout->getHexes()[slot], color);
+    }
+
+    // The page holding the slot, copying what another board shares on the way to it.
+    Page &writablePage(size_t slot)
+    {
+        const size_t index = slot >> PageBits;
+        if (root.use_count() > 1)
+        {
+            root = std::make_shared<Root>(*root);
+        }
+        std::shared_ptr<Directory> &directory = (*root)[index / DIRECTORY_PAGES];
+        if (directory.use_count() > 1)
+        {
+            directory = std::make_shared<Directory>(*directory);
+        }
+        std::shared_ptr<Page> &writable = (*directory)[index % DIRECTORY_PAGES];
+        if (writable.use_count() > 1)
+        {
+            writable = std::make_shared<Page>(*writable);
+        }
+        return *writable;
+    }
+
+public:
+    explicit BasicPersistentHexMap(const BasicHexMap<Layout> &hexMap)
+        : BasicPersistentHexMap(hexMap.getLayout(), hexMap.getColors())
+    {
+    }
+
+    // A board of the layout holding the colours, one per cell in slot order.
+    BasicPersistentHexMap(const Layout &layout_in, std::span<const PaletteIndex> colors)
+        : layout(std::make_shared<const Layout>(layout_in))
+    {
+        if (colors.size() != layout->size())
+        {
+            throw std::invalid_argument("PersistentHexMap: one colour per cell expected");
+        }
+
+        pageCount = (layout->size() + PAGE_MASK) >> PageBits;
+        root = std::make_shared<Root>((pageCount + DIRECTORY_PAGES - 1) / DIRECTORY_PAGES);
+        for (size_t p = 0; p < pageCount; p++)
+        {
+            auto &directory = (*root)[p / DIRECTORY_PAGES];
+            if (!directory)
+            {
+                directory = std::make_shared<Directory>();
+            }
+            auto newPage = std::make_shared<Page>();
+            newPage->fill(GHOST_COLOR);
+            const size_t first = p << PageBits;
+            std::ranges::copy(colors.subspan(first, std::min(PAGE_CELLS, colors.size() - first)), newPage->begin());
+            (*directory)[p % DIRECTORY_PAGES] = std::move(newPage);
+        }
+        hash = computeHash();
+    }
+
+    // An O(1) copy sharing every page, the same as copying the board.
+    BasicPersistentHexMap snapshot() const { return *this; }
+
+    size_t size() const { return layout->size(); }
+    const Layout &getLayout() const { return *layout; }
+    std::span<const Hex> getHexes() const { return layout->getHexes(); }
+    size_t getPageCount() const { return pageCount; }
+
+    // The colours of a page, PAGE_CELLS of them, past size() filled with GHOST_COLOR.
+    std::span<const PaletteIndex> getPage(size_t index) const { return page(index); }
+
+    // Whether this board and the other one hold the very same copy of a page.
+    bool sharesPage(const BasicPersistentHexMap &other, size_t index) const
+    {
+        return &page(index) == &other.page(index);
+    }
+
+    // Bytes held by the page table and its pages, counting shared parts in full.
+    size_t memoryUsage() const
+    {
+        return root->size() * (sizeof(std::shared_ptr<Directory>) + sizeof(Directory)) + pageCount * sizeof(Page);
+    }
+
+    std::uint64_t getHash() const { return hash; }
+
+    std::uint64_t computeHash() const
+    {
+        std::uint64_t result = 0;
+        forEachPage([&](size_t first, std::span<const PaletteIndex> colors)
+                    {
+            for (size_t i = 0; i < colors.size(); i++)
+            {
+                result ^= keyOf(first + i, colors[i]);
+            } });
+        return result;
+    }
+
+    PaletteIndex get(size_t slot) const
+    {
+        return page(slot >> PageBits)[slot & PAGE_MASK];
+    }
+
+    Cell at(const Hex &hex) const
+    {
+        auto slot = layout->find(hex);
+        if (!slot)
+        {
+            throw std::out_of_range("PersistentHexMap: hex is outside of the board");
+        }
+        return Cell(get(*slot));
+    }
+
+    /**
+     * Calls f(first slot, colours) for every page in slot order, with the colours of the
+     * page's cells as one contiguous span; the last page stops at size().
+     */
+    template <typename F>
+    void forEachPage(F &&f) const
+    {
+        const size_t cellCount = size();
+        for (size_t p = 0; p < pageCount; p++)
+        {
+            const size_t first = p << PageBits;
+            f(first, std::span<const PaletteIndex>(page(p)).first(std::min(PAGE_CELLS, cellCount - first)));
+        }
+    }
+
+    // Copies every colour into out, which holds size() of them.
+    void copyColors(std::span<PaletteIndex> out) const
+    {
+        forEachPage([out](size_t first, std::span<const PaletteIndex> colors)
+                    { std::ranges::copy(colors, out.begin() + static_cast<std::ptrdiff_t>(first)); });
+    }
+
+    void set(size_t slot, PaletteIndex color)
+    {
+        PaletteIndex &cell = writablePage(slot)[slot & PAGE_MASK];
+        hash ^= keyOf(slot, cell) ^ keyOf(slot, color);
+        cell = color;
+    }
+
+    // Rotates instantly, copying at most the pages of the three cells.
+    void applyCycle(const IndexCycle &cycle)
+    {
+        const PaletteIndex first = get(cycle.cells[0]);
+        set(cycle.cells[0], get(cycle.cells[1]));
+        set(cycle.cells[1], get(cycle.cells[2]));
+        set(cycle.cells[2], first);
+    }
+};
+
+using PersistentHexMap = BasicPersistentHexMap<HexagonLayout>;
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "palette.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// SplitMix64, used to spread a single seed over the xoshiro state.
+constexpr std::uint64_t splitMix64(std::uint64_t &state)
+{
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+/**
+ * xoshiro256** by Blackman and Vigna. Seeded explicitly, so the same seed gives the same
+ * sequence on every machine and standard library, unlike the std distributions.
+ *
+ * jump() advances the generator by 2^128 steps, so streams split off one seed with
+ * stream() never overlap in practice and can be handed to separate threads.
+ *
+ * Satisfies std::uniform_random_bit_generator.
+ */
+class Xoshiro256
+{
+    std::array<std::uint64_t, 4> state;
+
+    void applyJump(const std::array<std::uint64_t, 4> &polynomial)
+    {
+        std::array<std::uint64_t, 4> jumped{};
+        for (std::uint64_t word : polynomial)
+        {
+            for (int bit = 0; bit < 64; bit++)
+            {
+                if (word & (std::uint64_t{1} << bit))
+                {
+                    for (size_t i = 0; i < state.size(); i++)
+                    {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        state = jumped;
+    }
+
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed)
+    {
+        for (std::uint64_t &word : state)
+        {
+            word = splitMix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = std::rotl(state[3], 45);
+        return result;
+    }
+
+    // Advances 2^128 steps.
+    void jump()
+    {
+        applyJump({0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c});
+    }
+
+    // Advances 2^192 steps.
+    void longJump()
+    {
+        applyJump({0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635});
+    }
+
+    // The index'th independent stream of a seed: the seeded generator jumped index times.
+    static Xoshiro256 stream(std::uint64_t seed, size_t index)
+    {
+        Xoshiro256 rng(seed);
+        for (size_t i = 0; i < index; i++)
+        {
+            rng.jump();
+        }
+        return rng;
+    }
+};
+
+/**
+ * Fills out with palette indices below paletteSize. Each 64-bit output is cut into four
+ * 16-bit lanes that are scaled into [0, paletteSize) with a multiply and a shift, so
+ * there is no division and the lane loop vectorises. The bias is below paletteSize / 2^16.
+ */
+inline void fillPaletteIndices(Xoshiro256 &rng, std::span<PaletteIndex> out, size_t paletteSize)
+{
+    const std::uint32_t scale = static_cast<std::uint32_t>(paletteSize);
+    size_t i = 0;
+    for (; i + 4 <= out.size(); i += 4)
+    {
+        std::uint64_t bits = rng();
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            out[i + lane] = static_cast<PaletteIndex>(((bits >> (lane * 16)) & 0xffff) * scale >> 16);
+        }
+    }
+    if (i < out.size())
+    {
+        std::uint64_t bits = rng();
+        for (; i < out.size(); i++, bits >>= 16)
+        {
+            out[i] = static_cast<PaletteIndex>((bits & 0xffff) * scale >> 16);
+        }
+    }
+}
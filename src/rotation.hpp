@@ -0,0 +1,188 @@
+#pragma once
+
+#include "hex.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * A rotation of three cells as a permutation of cell indices: applying it moves the value
+ * at cells[1] to cells[0], cells[2] to cells[1] and cells[0] to cells[2]. That is one
+ * clockwise turn of a cursor triangle, and inverse() is the counter-clockwise turn
+ * that undoes it.
+ */
+class IndexCycle
+{
+public:
+    std::array<std::uint32_t, 3> cells{};
+
+    IndexCycle() = default;
+    IndexCycle(std::uint32_t cell0, std::uint32_t cell1, std::uint32_t cell2) : cells{cell0, cell1, cell2} {}
+
+    IndexCycle inverse() const
+    {
+        return IndexCycle(cells[0], cells[2], cells[1]);
+    }
+
+    // The slot the value at cells[i] ends up in.
+    std::uint32_t target(size_t i) const
+    {
+        return cells[(i + 2) % 3];
+    }
+
+    // values must hold every cell the cycle names.
+    template <typename T>
+    void apply(T *values) const
+    {
+        T first = values[cells[0]];
+        values[cells[0]] = values[cells[1]];
+        values[cells[1]] = values[cells[2]];
+        values[cells[2]] = first;
+    }
+
+    bool operator==(const IndexCycle &) const = default;
+};
+
+enum class Turn : std::uint8_t
+{
+    Clockwise,
+    CounterClockwise
+};
+
+// One move of the game: turning one triangle of a TriangleTable.
+struct TriangleMove
+{
+    std::uint32_t triangle;
+    Turn turn;
+
+    bool operator==(const TriangleMove &) const = default;
+};
+
+// The three hexes of the cursor triangle whose top cell is hex.
+inline std::array<Hex, 3> cursorTriangle(const Hex &hex)
+{
+    return {hex, hexNeighbour(hex, HexDirection::NorthWest), hexNeighbour(hex, HexDirection::NorthEast)};
+}
+
+// The ways a cursor steps between triangles, up and down being on screen.
+enum class CursorMove
+{
+    Up,
+    Down,
+    Left,
+    Right
+};
+
+/**
+ * Every rotation site of a board: each cursor triangle lying entirely on the board, in
+ * order of its top cell's slot. Per triangle the table holds its three hexes, the cycle
+ * that rotates them, the pixel pivot they turn around and the triangle one cursor move
+ * away in each direction (NO_TRIANGLE off the board), all as columns indexed by triangle.
+ *
+ * Moving up or down alternates between SouthEast/SouthWest (and NorthEast/NorthWest)
+ * steps by row, so the cursor travels straight up and down the screen; the table
+ * resolves that once instead of on every move. Like NeighbourTable it is a snapshot of
+ * the layout.
+ */
+class TriangleTable
+{
+    std::vector<std::array<Hex, 3>> hexes;
+    std::vector<IndexCycle> cycles;
+    std::vector<Point> pivots;
+    // Indexed by CursorMove.
+    std::vector<std::array<std::uint32_t, 4>> moves;
+    // Per cell slot, the triangle it is the top cell of.
+    std::vector<std::uint32_t> triangleOfTop;
+
+    static Hex moveTop(const Hex &top, CursorMove move)
+    {
+        switch (move)
+        {
+        case CursorMove::Up:
+            return hexNeighbour(top, top.r % 2 == 0 ? HexDirection::SouthEast : HexDirection::SouthWest);
+        case CursorMove::Down:
+            return hexNeighbour(top, top.r % 2 == 0 ? HexDirection::NorthEast : HexDirection::NorthWest);
+        case CursorMove::Left:
+            return hexNeighbour(top, HexDirection::West);
+        case CursorMove::Right:
+            return hexNeighbour(top, HexDirection::East);
+        }
+        return top;
+    }
+
+public:
+    static constexpr std::uint32_t NO_TRIANGLE = UINT32_MAX;
+
+    template <typename Layout>
+    explicit TriangleTable(const Layout &layout) : triangleOfTop(layout.size(), NO_TRIANGLE)
+    {
+        for (const Hex &hex : layout.getHexes())
+        {
+            std::array<Hex, 3> triangle = cursorTriangle(hex);
+            auto index0 = layout.find(triangle[0]);
+            auto index1 = layout.find(triangle[1]);
+            auto index2 = layout.find(triangle[2]);
+            if (!index1 || !index2)
+            {
+                continue;
+            }
+
+            triangleOfTop[*index0] = static_cast<std::uint32_t>(hexes.size());
+            hexes.push_back(triangle);
+            cycles.emplace_back(static_cast<std::uint32_t>(*index0), static_cast<std::uint32_t>(*index1),
+                                static_cast<std::uint32_t>(*index2));
+            Point pivot{0.0f, 0.0f};
+            for (const Hex &corner : triangle)
+            {
+                Point pixel = corner.toPixel();
+                pivot.x += pixel.x / 3.0f;
+                pivot.y += pixel.y / 3.0f;
+            }
+            pivots.push_back(pivot);
+        }
+
+        moves.reserve(hexes.size());
+        for (const auto &triangle : hexes)
+        {
+            std::array<std::uint32_t, 4> &row = moves.emplace_back();
+            for (size_t move = 0; move < row.size(); move++)
+            {
+                auto top = layout.find(moveTop(triangle[0], static_cast<CursorMove>(move)));
+                row[move] = top ? triangleOfTop[*top] : NO_TRIANGLE;
+            }
+        }
+    }
+
+    size_t size() const { return hexes.size(); }
+
+    const std::array<Hex, 3> &getHexes(size_t triangle) const { return hexes[triangle]; }
+    std::span<const IndexCycle> getCycles() const { return cycles; }
+    const IndexCycle &getCycle(size_t triangle) const { return cycles[triangle]; }
+
+    IndexCycle getCycle(const TriangleMove &move) const
+    {
+        const IndexCycle &cycle = cycles[move.triangle];
+        return move.turn == Turn::Clockwise ? cycle : cycle.inverse();
+    }
+    const Point &getPivot(size_t triangle) const { return pivots[triangle]; }
+
+    // The triangle one move away, or NO_TRIANGLE when that would leave the board.
+    std::uint32_t move(size_t triangle, CursorMove direction) const
+    {
+        return moves[triangle][static_cast<size_t>(direction)];
+    }
+
+    // The triangle with the given top cell, if it lies on the board.
+    template <typename Layout>
+    std::optional<std::uint32_t> find(const Layout &layout, const Hex &top) const
+    {
+        auto index = layout.find(top);
+        if (!index || triangleOfTop[*index] == NO_TRIANGLE)
+        {
+            return std::nullopt;
+        }
+        return triangleOfTop[*index];
+    }
+};
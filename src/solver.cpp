@@ -0,0 +1,244 @@
+#include "solver.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+
+SolverSearch::SolverSearch(const HexMap &start, const TriangleTable &triangles_in, const ZobristTable &keys_in,
+                           TranspositionTable &table_in)
+    : board(start), keys(&keys_in), triangles(&triangles_in), table(&table_in)
+{
+}
+
+void SolverSearch::setGoal(const SolveGoal &goal_in)
+{
+    if (!goal_in.predicate && goal_in.colors.size() != board.size())
+    {
+        throw std::invalid_argument("Solver: one goal colour per cell expected");
+    }
+    goal = goal_in;
+    canonical.reset();
+    if (goal.symmetries)
+    {
+        canonical.emplace(*goal.symmetries, *keys, board.getColors(), SymmetryGroup::TrianglePreserving);
+    }
+    misplaced = 0;
+    if (!goal.predicate)
+    {
+        for (size_t i = 0; i < board.size(); i++)
+        {
+            misplaced += board.getColors()[i] != goal.colors[i];
+        }
+    }
+}
+
+size_t SolverSearch::misplacedIn(const IndexCycle &cycle) const
+{
+    const auto colors = board.getColors();
+    size_t count = 0;
+    for (std::uint32_t cell : cycle.cells)
+    {
+        count += colors[cell] != goal.colors[cell];
+    }
+    return count;
+}
+
+void SolverSearch::applyCycle(const IndexCycle &cycle)
+{
+    if (canonical)
+    {
+        canonical->applyCycle(cycle, board.getColors());
+    }
+    if (goal.predicate)
+    {
+        board.applyCycle(cycle, *keys);
+        return;
+    }
+    misplaced -= misplacedIn(cycle);
+    board.applyCycle(cycle, *keys);
+    misplaced += misplacedIn(cycle);
+}
+
+void SolverSearch::apply(const TriangleMove &move)
+{
+    applyCycle(triangles->getCycle(move));
+    path.push_back(move);
+    nodes++;
+}
+
+void SolverSearch::undo()
+{
+    applyCycle(triangles->getCycle(path.back()).inverse());
+    path.pop_back();
+}
+
+void SolverSearch::rewind()
+{
+    while (!path.empty())
+    {
+        undo();
+    }
+}
+
+int SolverSearch::heuristic() const
+{
+    return goal.predicate ? 0 : static_cast<int>((misplaced + 2) / 3);
+}
+
+bool SolverSearch::isGoal() const
+{
+    return goal.predicate ? (*goal.predicate)(board) : misplaced == 0;
+}
+
+int SolverSearch::search(int depth, int bound, std::uint8_t iteration)
+{
+    const int estimate = depth + heuristic();
+    if (estimate > bound)
+    {
+        return estimate;
+    }
+    if (isGoal())
+    {
+        return FOUND;
+    }
+    if (!table->visit(tableKey(), iteration, static_cast<std::uint8_t>(depth)))
+    {
+        return INT_MAX;
+    }
+    return searchChildren(depth, bound, iteration);
+}
+
+int SolverSearch::searchChildren(int depth, int bound, std::uint8_t iteration)
+{
+    if (stop && stop->load(std::memory_order_relaxed))
+    {
+        return INT_MAX;
+    }
+
+    const std::uint32_t lastTriangle = path.empty() ? TriangleTable::NO_TRIANGLE : path.back().triangle;
+    int nextBound = INT_MAX;
+    for (std::uint32_t triangle = 0; triangle < triangles->size(); triangle++)
+    {
+        // Turning the same triangle again either undoes the last move or equals the
+        // opposite single turn, which the previous depth already tried.
+        if (triangle == lastTriangle)
+        {
+            continue;
+        }
+        for (Turn turn : {Turn::Clockwise, Turn::CounterClockwise})
+        {
+            const TriangleMove move{triangle, turn};
+            const IndexCycle cycle = triangles->getCycle(move);
+            applyCycle(cycle);
+            path.push_back(move);
+            nodes++;
+
+            int result = search(depth + 1, bound, iteration);
+            if (result == FOUND)
+            {
+                return FOUND;
+            }
+            nextBound = std::min(nextBound, result);
+
+            path.pop_back();
+            applyCycle(cycle.inverse());
+        }
+    }
+    return nextBound;
+}
+
+size_t solverSearchMemory(const HexMap &board)
+{
+    // The board copy holds a colour, a hex and a pixel per cell.
+    return sizeof(SolverSearch) + board.size() * (sizeof(PaletteIndex) + sizeof(Hex) + sizeof(Point));
+}
+
+bool sameColorCounts(std::span<const PaletteIndex> board, std::span<const PaletteIndex> goal)
+{
+    std::array<size_t, 256> have{};
+    std::array<size_t, 256> want{};
+    for (PaletteIndex color : board)
+    {
+        have[color]++;
+    }
+    for (PaletteIndex color : goal)
+    {
+        want[color]++;
+    }
+    return have == want;
+}
+
+std::uint8_t nextIteration(std::uint8_t iteration, TranspositionTable &table)
+{
+    // Entries of earlier iterations were searched to a smaller bound, so they must not
+    // prune a new one. The stamp is 8 bits, start over with a clean table on wrap.
+    if (++iteration == 0)
+    {
+        table.clear();
+        iteration = 1;
+    }
+    return iteration;
+}
+
+Solver::Solver(const HexMap &start, int tableBits)
+    : triangles(start.getLayout()), keys(start.getLayout()), symmetries(start.getLayout()), table(tableBits),
+      searcher(start, triangles, keys, table)
+{
+}
+
+SolveResult Solver::run(int maxDepth)
+{
+    if (maxDepth > UINT8_MAX)
+    {
+        throw std::invalid_argument("Solver: maxDepth must fit the transposition table");
+    }
+
+    SolveResult result;
+    searcher.resetNodes();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int bound = searcher.heuristic(); bound <= maxDepth;)
+    {
+        iteration = nextIteration(iteration, table);
+        int next = searcher.search(0, bound, iteration);
+        if (next == SolverSearch::FOUND)
+        {
+            result.solved = true;
+            result.moves = searcher.getPath();
+            break;
+        }
+        if (next == INT_MAX)
+        {
+            break;
+        }
+        bound = next;
+    }
+
+    // Leave the board as it started for the next solve().
+    searcher.rewind();
+
+    result.nodes = searcher.getNodes();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.memoryUsage = table.memoryUsage() + keys.memoryUsage() + symmetries.memoryUsage() +
+                         solverSearchMemory(searcher.getBoard()) +
+                         triangles.size() * (sizeof(IndexCycle) + sizeof(Point) + 3 * sizeof(Hex) + 4 * sizeof(std::uint32_t));
+    return result;
+}
+
+SolveResult Solver::solve(std::span<const PaletteIndex> goal, int maxDepth)
+{
+    // Rotations only move colours around, a goal with other colour counts is unreachable.
+    if (!sameColorCounts(searcher.getBoard().getColors(), goal))
+    {
+        return SolveResult{};
+    }
+    searcher.setGoal(SolveGoal{goal, nullptr});
+    return run(maxDepth);
+}
+
+SolveResult Solver::solve(const GoalPredicate &goal, int maxDepth, bool symmetric)
+{
+    searcher.setGoal(SolveGoal{{}, &goal, symmetric ? &symmetries : nullptr});
+    return run(maxDepth);
+}
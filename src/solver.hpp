@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hex_map.hpp"
+#include "rotation.hpp"
+#include "symmetry.hpp"
+#include "transposition_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct SolveResult
+{
+    bool solved = false;
+    // Shortest sequence of moves from the start board to a goal board.
+    std::vector<TriangleMove> moves;
+    std::uint64_t nodes = 0;
+    double seconds = 0.0;
+    // Bytes held by the transposition table and the search state.
+    size_t memoryUsage = 0;
+
+    double nodesPerSecond() const { return seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0; }
+};
+
+using GoalPredicate = std::function<bool(const HexMap &)>;
+
+// What a search looks for: exactly the goal colours, or any board the predicate accepts.
+struct SolveGoal
+{
+    std::span<const PaletteIndex> colors;
+    const GoalPredicate *predicate = nullptr;
+    // Set when the goal is the same for every board of a triangle preserving symmetry
+    // orbit, so the search keeps one table entry per orbit.
+    const BoardSymmetries *symmetries = nullptr;
+};
+
+/**
+ * The state of one depth-first search thread: its own copy of the board, the moves
+ * applied to it since the start and the misplaced cell count the heuristic needs. The
+ * triangle, Zobrist key and transposition tables are shared, so several searches can
+ * work on one puzzle at once.
+ */
+class SolverSearch
+{
+    HexMap board;
+    const ZobristTable *keys;
+    const TriangleTable *triangles;
+    TranspositionTable *table;
+    SolveGoal goal;
+    size_t misplaced = 0;
+    std::optional<CanonicalHash> canonical;
+    std::vector<TriangleMove> path;
+    std::uint64_t nodes = 0;
+    const std::atomic<bool> *stop = nullptr;
+
+    size_t misplacedIn(const IndexCycle &cycle) const;
+    void applyCycle(const IndexCycle &cycle);
+
+public:
+    static constexpr int FOUND = -1;
+
+    SolverSearch(const HexMap &start, const TriangleTable &triangles_in, const ZobristTable &keys_in,
+                 TranspositionTable &table_in);
+
+    // Throws when the goal colours do not match the board size.
+    void setGoal(const SolveGoal &goal_in);
+    // Once set, searches bail out as soon as the flag is raised.
+    void setStop(const std::atomic<bool> *stop_in) { stop = stop_in; }
+
+    const HexMap &getBoard() const { return board; }
+    const std::vector<TriangleMove> &getPath() const { return path; }
+    std::uint64_t getNodes() const { return nodes; }
+    void resetNodes() { nodes = 0; }
+
+    void apply(const TriangleMove &move);
+    void undo();
+    // Undoes every move, back to the start board.
+    void rewind();
+
+    int heuristic() const;
+    bool isGoal() const;
+    // The transposition table key of the current board.
+    std::uint64_t tableKey() const { return canonical ? canonical->getCanonical() : board.getHash(); }
+
+    /**
+     * Searches below the current board, which is at the given depth, up to bound.
+     *
+     * @return FOUND with the solution left in getPath(), otherwise the smallest estimate
+     *         that exceeded bound (INT_MAX when there was none).
+     */
+    int search(int depth, int bound, std::uint8_t iteration);
+
+    // search() minus the checks on the current board itself, for callers that did them.
+    int searchChildren(int depth, int bound, std::uint8_t iteration);
+};
+
+// Bytes a SolverSearch and its board take.
+size_t solverSearchMemory(const HexMap &board);
+
+/**
+ * Finds a shortest sequence of triangle rotations that turns a board into a goal, with
+ * iterative deepening A*. Moves are applied and undone in place on one copy of the
+ * board, whose Zobrist hash keys a TranspositionTable that prunes boards already
+ * reached no deeper in the same iteration.
+ *
+ * Against a goal board the heuristic is the number of cells holding the wrong colour
+ * divided by three, rounded up: a rotation changes at most three cells, so it never
+ * overestimates. Against a goal predicate there is no heuristic and the search is plain
+ * iterative deepening.
+ *
+ * Meant for small puzzles, radius 3 and 4 boards with solutions of up to a dozen moves.
+ */
+class Solver
+{
+    TriangleTable triangles;
+    ZobristTable keys;
+    BoardSymmetries symmetries;
+    TranspositionTable table;
+    SolverSearch searcher;
+    std::uint8_t iteration = 0;
+
+    SolveResult run(int maxDepth);
+
+public:
+    // tableBits sizes the transposition table at 2^tableBits entries of 8 bytes.
+    explicit Solver(const HexMap &start, int tableBits = 22);
+
+    // The search points into the solver's own tables, so a Solver stays where it was built.
+    Solver(const Solver &) = delete;
+    Solver &operator=(const Solver &) = delete;
+    Solver(Solver &&) = delete;
+    Solver &operator=(Solver &&) = delete;
+
+    const TriangleTable &getTriangles() const { return triangles; }
+
+    // Searches for a board with exactly the goal colours, one per cell in slot order.
+    SolveResult solve(std::span<const PaletteIndex> goal, int maxDepth = 20);
+
+    /**
+     * Searches for any board the predicate accepts. With symmetric set the predicate must
+     * give the same answer for boards related by a triangle preserving symmetry, and
+     * the search explores each orbit of such boards once.
+     */
+    SolveResult solve(const GoalPredicate &goal, int maxDepth = 20, bool symmetric = false);
+};
+
+// Whether the board has the same number of cells of every colour as the goal.
+bool sameColorCounts(std::span<const PaletteIndex> board, std::span<const PaletteIndex> goal);
+
+// The next 8-bit iteration stamp, clearing the table when the stamp wraps around.
+std::uint8_t nextIteration(std::uint8_t iteration, TranspositionTable &table);
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "hex.hpp"
+#include "hex_map.hpp"
+#include "palette.hpp"
+#include "rotation.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+const size_t SYMMETRY_COUNT{12};
+
+/**
+ * Maps a hex through one of the 12 symmetries of a hexagon around the origin. Symmetries
+ * 0-5 rotate by that many 60 degree steps, 6-11 first reflect across the q axis (swapping
+ * r and s) and then rotate by symmetry - 6 steps.
+ */
+constexpr Hex hexSymmetry(const Hex &hex, size_t symmetry)
+{
+    Hex result = symmetry >= 6 ? Hex(hex.q, hex.s, hex.r) : hex;
+    for (size_t step = 0; step < symmetry % 6; step++)
+    {
+        result = Hex(-result.r, -result.s, -result.q);
+    }
+    return result;
+}
+
+/**
+ * Whether the symmetry maps every cursor triangle onto a cursor triangle, so boards it
+ * relates are the same puzzle. Odd rotations turn the triangles upside down; the even
+ * ones and their reflections keep them.
+ */
+constexpr bool preservesTriangles(size_t symmetry)
+{
+    return symmetry % 2 == 0;
+}
+
+/**
+ * The 12 symmetries of a hexagon board as slot permutations. Per symmetry the table holds
+ * the slot every cell moves to and, inverted, the slot every cell of the image comes
+ * from, so transforming a board is one gather over its colour column.
+ */
+class BoardSymmetries
+{
+    size_t cellCount;
+    // [symmetry * cellCount + slot]
+    std::vector<std::uint32_t> images;
+    std::vector<std::uint32_t> sources;
+
+public:
+    // Throws when the layout's shape is not symmetric around the origin.
+    template <typename Layout>
+    explicit BoardSymmetries(const Layout &layout)
+        : cellCount(layout.size()), images(SYMMETRY_COUNT * layout.size()), sources(SYMMETRY_COUNT * layout.size())
+    {
+        const auto hexes = layout.getHexes();
+        for (size_t symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            for (size_t i = 0; i < cellCount; i++)
+            {
+                auto image = layout.find(hexSymmetry(hexes[i], symmetry));
+                if (!image)
+                {
+                    throw std::invalid_argument("BoardSymmetries: board shape is not symmetric");
+                }
+                images[symmetry * cellCount + i] = static_cast<std::uint32_t>(*image);
+                sources[symmetry * cellCount + *image] = static_cast<std::uint32_t>(i);
+            }
+        }
+    }
+
+    size_t size() const { return cellCount; }
+    size_t memoryUsage() const { return (images.size() + sources.size()) * sizeof(std::uint32_t); }
+
+    // The slot each cell moves to under the symmetry.
+    std::span<const std::uint32_t> getImages(size_t symmetry) const
+    {
+        return std::span(images).subspan(symmetry * cellCount, cellCount);
+    }
+
+    // The slot each cell of the transformed board comes from.
+    std::span<const std::uint32_t> getSources(size_t symmetry) const
+    {
+        return std::span(sources).subspan(symmetry * cellCount, cellCount);
+    }
+
+    // Writes the board transformed by the symmetry to out, which holds size() colours.
+    void transform(size_t symmetry, std::span<const PaletteIndex> colors, std::span<PaletteIndex> out) const
+    {
+        const std::uint32_t *source = sources.data() + symmetry * cellCount;
+        for (size_t i = 0; i < cellCount; i++)
+        {
+            out[i] = colors[source[i]];
+        }
+    }
+
+    // The slot a cell moves to under the symmetry.
+    std::uint32_t image(size_t symmetry, size_t cell) const { return images[symmetry * cellCount + cell]; }
+};
+
+enum class SymmetryGroup
+{
+    // All 12 symmetries, for goals that do not care about the move set's orientation.
+    All,
+    // The 6 symmetries that preserve cursor triangles, safe for deduplicating searches.
+    TrianglePreserving
+};
+
+/**
+ * The Zobrist hash of a board under every symmetry at once, kept up to date in O(1) per
+ * rotation. The canonical hash, the smallest over a symmetry group, is the same for
+ * every board of an orbit, so searches can store one entry per orbit. Symmetry 0 is the
+ * identity, its hash equals BasicHexMap::getHash().
+ *
+ * The keys come from a ZobristTable of the board's layout, so only palette colours are
+ * supported.
+ */
+class CanonicalHash
+{
+    const BoardSymmetries *symmetries;
+    const ZobristTable *keys;
+    SymmetryGroup group;
+    std::array<std::uint64_t, SYMMETRY_COUNT> hashes{};
+
+    // zobristKey() of the image of a cell holding a palette colour.
+    std::uint64_t imageKey(size_t symmetry, size_t cell, PaletteIndex color) const
+    {
+        return (*keys)[symmetries->image(symmetry, cell)][color];
+    }
+
+public:
+    CanonicalHash(const BoardSymmetries &symmetries_in, const ZobristTable &keys_in,
+                  std::span<const PaletteIndex> colors, SymmetryGroup group_in = SymmetryGroup::TrianglePreserving)
+        : symmetries(&symmetries_in), keys(&keys_in), group(group_in)
+    {
+        for (size_t symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            for (size_t i = 0; i < colors.size(); i++)
+            {
+                hashes[symmetry] ^= imageKey(symmetry, i, colors[i]);
+            }
+        }
+    }
+
+    std::uint64_t getHash(size_t symmetry) const { return hashes[symmetry]; }
+
+    // The smallest hash over the group.
+    std::uint64_t getCanonical() const
+    {
+        return hashes[getCanonicalSymmetry()];
+    }
+
+    // The symmetry that gives the canonical hash.
+    size_t getCanonicalSymmetry() const
+    {
+        size_t best = 0;
+        for (size_t symmetry = 1; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            if ((group == SymmetryGroup::All || preservesTriangles(symmetry)) && hashes[symmetry] < hashes[best])
+            {
+                best = symmetry;
+            }
+        }
+        return best;
+    }
+
+    // Updates the hashes for the cycle, given the colours from before it is applied.
+    void applyCycle(const IndexCycle &cycle, std::span<const PaletteIndex> colorsBefore)
+    {
+        std::array<PaletteIndex, 3> before;
+        for (size_t i = 0; i < before.size(); i++)
+        {
+            before[i] = colorsBefore[cycle.cells[i]];
+        }
+        for (size_t symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            std::uint64_t delta = 0;
+            for (size_t i = 0; i < before.size(); i++)
+            {
+                // cells[i] takes over the colour of cells[i + 1].
+                delta ^= imageKey(symmetry, cycle.cells[i], before[i]) ^
+                         imageKey(symmetry, cycle.cells[i], before[(i + 1) % 3]);
+            }
+            hashes[symmetry] ^= delta;
+        }
+    }
+};
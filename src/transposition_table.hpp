@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Lock-free, lossy table of board hashes reached during a search, one 64-bit word per
+ * entry: the hash's upper 48 bits as a tag, then the search iteration and the depth the
+ * board was reached at. Entries are read and written with single relaxed atomic
+ * operations, so any number of threads can share a table; a torn race only ever loses an
+ * entry, which costs a re-search but never a wrong answer, as a tag match is required.
+ */
+class TranspositionTable
+{
+    std::vector<std::atomic<std::uint64_t>> entries;
+    std::uint64_t mask;
+
+    static constexpr std::uint64_t TAG_MASK = ~std::uint64_t{0xFFFF};
+
+public:
+    // A table of 2^bits entries.
+    explicit TranspositionTable(int bits) : entries(size_t{1} << bits), mask((std::uint64_t{1} << bits) - 1) {}
+
+    size_t size() const { return entries.size(); }
+    size_t memoryUsage() const { return entries.size() * sizeof(std::uint64_t); }
+
+    void clear()
+    {
+        for (auto &entry : entries)
+        {
+            entry.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Records that the board was reached at depth in the given iteration.
+     *
+     * @return False when the board was already reached at the same or a smaller depth in
+     *         this iteration, so the caller's subtree is already covered.
+     */
+    bool visit(std::uint64_t hash, std::uint8_t iteration, std::uint8_t depth)
+    {
+        // Index by the low bits, tag by the high bits, so the two stay independent.
+        std::atomic<std::uint64_t> &entry = entries[hash & mask];
+        const std::uint64_t stamp = (hash & TAG_MASK) | (std::uint64_t{iteration} << 8);
+        const std::uint64_t stored = entry.load(std::memory_order_relaxed);
+        if ((stored & ~std::uint64_t{0xFF}) == stamp && (stored & 0xFF) <= depth)
+        {
+            return false;
+        }
+        entry.store(stamp | depth, std::memory_order_relaxed);
+        return true;
+    }
+};
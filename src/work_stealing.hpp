@@ -0,0 +1,154 @@
+#pragma once
+
+#include "parallel.hpp"
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Runs tasks on a fixed set of workers, each with its own deque. A worker pushes and pops
+ * at the back of its own deque, so it keeps working depth first on what it just split
+ * off, and when it runs dry it steals from the front of the others, where the oldest and
+ * usually largest tasks wait. Tasks may push more tasks while they run.
+ *
+ * Each deque sits behind its own mutex; the owner is the only one at the back and
+ * thieves are rare, so the locks are practically uncontended.
+ */
+template <typename Task>
+class WorkStealingScheduler
+{
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    // Tasks pushed and not finished yet, the run is over when it drops to zero.
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned> idle{0};
+    std::atomic<bool> stopped{false};
+
+    std::optional<Task> popOwn(unsigned worker)
+    {
+        Worker &own = *workers[worker];
+        std::lock_guard lock(own.mutex);
+        if (own.tasks.empty())
+        {
+            return std::nullopt;
+        }
+        Task task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return task;
+    }
+
+    std::optional<Task> steal(unsigned thief)
+    {
+        for (size_t offset = 1; offset < workers.size(); offset++)
+        {
+            Worker &victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                Task task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+public:
+    explicit WorkStealingScheduler(unsigned threadCount)
+    {
+        threadCount = resolveThreadCount(threadCount);
+        for (unsigned i = 0; i < threadCount; i++)
+        {
+            workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Whether some worker is looking for work, a hint that splitting a task pays off.
+    bool hasIdleWorkers() const { return idle.load(std::memory_order_relaxed) > 0; }
+
+    void push(unsigned worker, Task task)
+    {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        Worker &own = *workers[worker];
+        std::lock_guard lock(own.mutex);
+        own.tasks.push_back(std::move(task));
+    }
+
+    // Makes run() return as soon as every worker finished its current task.
+    void stop() { stopped.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Calls f(worker, task) on size() threads, the calling thread being worker 0, until
+     * every task is done or stop() was called. Tasks left over after a stop are dropped.
+     */
+    template <typename F>
+    void run(F &&f)
+    {
+        auto work = [&](unsigned worker)
+        {
+            bool searching = false;
+            while (!stopped.load(std::memory_order_relaxed))
+            {
+                std::optional<Task> task = popOwn(worker);
+                if (!task)
+                {
+                    task = steal(worker);
+                }
+                if (!task)
+                {
+                    if (pending.load(std::memory_order_acquire) == 0)
+                    {
+                        break;
+                    }
+                    if (!searching)
+                    {
+                        idle.fetch_add(1, std::memory_order_relaxed);
+                        searching = true;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (searching)
+                {
+                    idle.fetch_sub(1, std::memory_order_relaxed);
+                    searching = false;
+                }
+                f(worker, std::move(*task));
+                pending.fetch_sub(1, std::memory_order_release);
+            }
+            if (searching)
+            {
+                idle.fetch_sub(1, std::memory_order_relaxed);
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            for (unsigned worker = 1; worker < workers.size(); worker++)
+            {
+                threads.emplace_back(work, worker);
+            }
+            work(0);
+        }
+
+        for (auto &worker : workers)
+        {
+            worker->tasks.clear();
+        }
+        pending.store(0, std::memory_order_relaxed);
+        stopped.store(false, std::memory_order_relaxed);
+    }
+};